@@ -0,0 +1,68 @@
+#ifndef STEAM_API_CLIENT_HPP
+#define STEAM_API_CLIENT_HPP
+
+#include <chrono>
+#include <functional>
+#include <istream>
+#include <string>
+#include "base.hpp"
+
+STEAM_BEGIN_NAMESPACE
+/**
+ * @brief Pool of keep-alive HTTPS connections to the Steam Web API, shared by every caller.
+ * * Each pooled httplib::Client keeps its connection open between requests, so the API key check and every
+ * * request of every fetch reuse one TCP and TLS handshake instead of paying for a new one. A request leases
+ * * an idle client (the most recently used one), or opens a new one while fewer than the pool size exist,
+ * * or waits for one to come back. Clients idle for longer than the idle timeout are closed before a lease.
+ */
+namespace api_client {
+
+const std::string kSteamApiHost          = "https://api.steampowered.com";
+const size_t      kDefaultPoolSize       = 4;  /* * Connections open at once; STEAM_HTTP_POOL_SIZE overrides it */
+const int         kDefaultIdleSeconds    = 60; /* * Idle time before closing one; STEAM_HTTP_IDLE_SECONDS overrides it */
+const int         kConnectTimeoutSeconds = 10;
+const size_t      kStreamBufferBytes     = 1 << 20; /* * Body bytes GetStreamed holds ahead of its reader */
+
+/* * Request and connection counters since the start; connections_opened counts TCP and TLS handshakes. */
+struct PoolStats
+{
+        size_t requests           = 0;
+        size_t connections_opened = 0;
+        size_t idle_closed        = 0; /* * Connections closed by the idle timeout */
+        size_t open               = 0; /* * Clients currently in the pool, leased or idle */
+};
+
+/**
+ * @brief Sets the pool size and idle timeout. StartLoadingData calls it before any request is made.
+ * @param pool_size At least 1.
+ */
+void Configure(size_t pool_size, std::chrono::seconds idle_timeout);
+
+/**
+ * @brief Sends a GET to kSteamApiHost on a pooled keep-alive connection.
+ * * Safe to call from several threads at once; each request has a connection to itself.
+ * @param path Path and query, starting with '/'.
+ * @param read_timeout_seconds How long to wait for the response.
+ */
+httplib::Result Get(const std::string& path, int read_timeout_seconds);
+
+/**
+ * @brief Like Get, but hands the response body to read_body as a stream while it is still downloading.
+ * * The request runs on a helper thread that feeds the body chunk by chunk through a pipe holding at most
+ * * about kStreamBufferBytes, so the whole body is never in memory at once and reading overlaps the
+ * * download. Whatever read_body leaves unread is discarded. The body is streamed whatever the status, so
+ * * check the returned status before trusting what read_body made of it.
+ * @param read_body Runs on the calling thread; reads until it has what it needs or the stream ends.
+ */
+httplib::Result GetStreamed(const std::string&                       path,
+                            int                                      read_timeout_seconds,
+                            const std::function<void(std::istream&)>& read_body);
+
+PoolStats GetPoolStats();
+
+/* * Connections the pool may hold open at once, which is how many requests can run in parallel. */
+size_t PoolSize();
+} // namespace api_client
+STEAM_END_NAMESPACE
+
+#endif
@@ -15,16 +15,33 @@ namespace api_key {
 
 /**
  * @brief Check API Key validity.
+ * * A verdict from the last kApiKeyCacheHours is taken from GetApiKeyCachePath() without a network call, so
+ * * an offline start with a known key does not wait on the API. Fresh verdicts are cached by a hash of the
+ * * key; a failed connection is not cached.
  * @return True if the API key was valid, false otherwise.
  */
 bool isSteamAPIKeyValid(const std::string& key);
 
 /**
- * @brief Loads the Steam API key from the .env file.
+ * @brief Caches a key as invalid after the API refused it (401 or 403) during a fetch.
+ * * Keeps a key that stopped working from passing the cached check until its entry expires.
+ */
+void RecordRejectedKey(const std::string& key);
+
+/**
+ * @brief Reads STEAM_API_KEY from the environment, or an empty string when it is unset.
+ * * Call it on the main thread after dotenv::init; background tasks take the value instead of reading it.
+ */
+std::string ReadEnvApiKey();
+
+/**
+ * @brief Loads the Steam API key from the environment value or the .env file.
+ * * Never touches the environment itself, so it is safe on a background thread.
+ * @param env_api_key STEAM_API_KEY as returned by ReadEnvApiKey.
  * @return True if the API key was successfully loaded, false otherwise.
  * ! Critical for the application to connect to Steam API.
  */
-bool LoadApiKeyFromEnv();
+bool LoadApiKeyFromEnv(const std::string& env_api_key);
 } // namespace api_key
 STEAM_END_NAMESPACE
 
@@ -0,0 +1,144 @@
+#ifndef STEAM_CATALOG_HPP
+#define STEAM_CATALOG_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "data.hpp"
+#include "infix.hpp"
+#include "prefix.hpp"
+#include "token.hpp"
+
+STEAM_BEGIN_NAMESPACE
+/**
+ * @brief Single entry point for changing the game library.
+ * * steam_game_collection and every index over it (prefix tree, name and AppID maps, infix and word
+ * * indexes) are updated together here, one game at a time, so a refresh that touches a few games
+ * * costs a few updates instead of a rebuild. A new index only needs to be added to IndexGame and
+ * * UnindexGame in catalog.cpp.
+ * * A read-only process can instead borrow the collection and every index from a mapped snapshot
+ * * (BorrowColumns and the indexes' own Borrow methods); any change first copies them (OwnIndexes).
+ */
+namespace catalog {
+
+/* * Libraries at least this large are indexed on several threads when loaded in bulk. */
+const size_t kParallelBuildMinGames = 16384;
+
+/* * A fetch that changes more than 1/kDeltaRebuildDivisor of the library is loaded in bulk instead of applied. */
+const size_t kDeltaRebuildDivisor = 4;
+
+/* * A game whose playtime differs between the library and a fresh fetch. */
+struct PlaytimeChange
+{
+        int         app_id;
+        std::string name;
+        int         old_playtime;
+        int         new_playtime;
+};
+
+/* * A game whose name differs between the library and a fresh fetch. */
+struct NameChange
+{
+        int         app_id;
+        std::string old_name;
+        std::string new_name;
+};
+
+/* * What ApplyFetchedGames found between the library and a fresh fetch, and what applying it cost. */
+struct LibraryDiff
+{
+        std::vector<data::GameData> added;
+        std::vector<data::GameData> removed;
+        std::vector<PlaytimeChange> playtime_changes;
+        std::vector<NameChange>     renamed;
+        size_t                      index_entries = 0;     /* * Index entries added, removed or moved */
+        bool                        rebuilt       = false; /* * Too many changes: loaded in bulk instead */
+
+        size_t ChangeCount() const
+        {
+                return added.size() + removed.size() + playtime_changes.size() + renamed.size();
+        }
+};
+
+/* * Empties the collection and every index. */
+void Clear();
+
+/**
+ * @brief Reserves room ahead of a bulk load.
+ * @param game_count Expected number of games.
+ */
+void Reserve(size_t game_count);
+
+/**
+ * @brief Replaces the whole library with columns copied verbatim, then indexes every game.
+ * * Skips re-lowering names, so loading a snapshot only pays for building the indexes, and not even
+ * * that when restore_indexes can fill them from a saved copy. From kParallelBuildMinGames games on, the
+ * * indexes are built concurrently and the prefix tree is split across the remaining cores.
+ * @param columns Columns whose offsets and lengths have already been checked against the arena.
+ * @param restore_indexes Optional; runs once the columns are stored and the indexes are empty. If it returns
+ * false the indexes are cleared again and rebuilt game by game.
+ * @return True if the indexes were restored rather than rebuilt.
+ */
+bool LoadColumns(const data::GameColumns& columns, const std::function<bool()>& restore_indexes = nullptr);
+
+/**
+ * @brief Like LoadColumns, but the collection reads the columns in place instead of copying them.
+ * * Every index is left empty for the caller to borrow from the same snapshot.
+ * @param columns Columns that stay valid while the collection borrows them.
+ */
+void BorrowColumns(const data::GameColumns& columns);
+
+/**
+ * @brief Serves FindGameByName and FindGameByAppId from game indices stored elsewhere instead of the maps.
+ * @param by_name The name map's game indices, ordered by lowercase name.
+ * @param by_app_id The AppID map's game indices, ordered by AppID.
+ */
+void BorrowLookups(ArrayView<std::uint32_t> by_name, ArrayView<std::uint32_t> by_app_id);
+
+/* * Copies every borrowed index into owned memory so it can be changed; AddGame and the others call it. */
+void OwnIndexes();
+
+/* * Index of the game with an AppID, or steam_game_collection.size() if there is none. */
+size_t FindGameByAppId(int app_id);
+
+/* * Index of the game whose name matches ignoring case, or steam_game_collection.size() if there is none. */
+size_t FindGameByName(std::string_view name);
+
+/**
+ * @brief Appends a game to the collection and indexes it.
+ * @param game The game to add.
+ * @return The new game's index in steam_game_collection.
+ */
+size_t AddGame(const data::GameData& game);
+
+/**
+ * @brief Removes the game with the given AppID.
+ * * The last game moves into the freed slot, so only that game is re-indexed and no other index shifts.
+ * @return False if no game has that AppID.
+ */
+bool RemoveGame(int app_id);
+
+/**
+ * @brief Changes a game's name in the collection and in every name index.
+ * @return False if no game has that AppID.
+ */
+bool RenameGame(int app_id, const std::string& new_name);
+
+/**
+ * @brief Changes a game's playtime and refreshes the prefix tree's playtime caches along its name.
+ * @return False if no game has that AppID.
+ */
+bool SetPlaytime(int app_id, int playtime_forever);
+
+/**
+ * @brief Makes the library match a freshly fetched game list by applying only what differs, matched by AppID.
+ * * Added games go through AddGame, missing ones through RemoveGame, and changed names and playtimes through
+ * * RenameGame and SetPlaytime, so an unchanged game costs one AppID lookup and no index work. When more
+ * * than 1/kDeltaRebuildDivisor of the library changed, the list is loaded with LoadColumns instead.
+ * @param fetched The complete fresh list for the account the library already holds.
+ */
+LibraryDiff ApplyFetchedGames(const data::GameCollection& fetched);
+} // namespace catalog
+STEAM_END_NAMESPACE
+
+#endif
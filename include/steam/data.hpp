@@ -19,6 +19,18 @@
  */
 #include <string>
 
+/**
+ * @include string_view
+ * @brief used for non-owning views into the GameCollection name arena
+ */
+#include <string_view>
+
+/**
+ * @include cstdint
+ * @brief used for the fixed-width GameCollection columns
+ */
+#include <cstdint>
+
 /**
  * @include vector
  * @brief used for
@@ -26,6 +38,7 @@
 #include <vector>
 
 #include "base.hpp"
+#include "shared_array.hpp"
 STEAM_BEGIN_NAMESPACE
 
 namespace data {
@@ -35,6 +48,191 @@ struct GameData
         int         app_id;
         int         playtime_forever;
 };
+
+/**
+ * @brief Read-only view of one game stored in a GameCollection.
+ * * The string views point into the collection's name arena and are invalidated by the next modification.
+ */
+struct GameView
+{
+        std::string_view name;
+        std::string_view lower_name;
+        int              app_id;
+        int              playtime_forever;
+};
+
+/**
+ * @brief Borrowed pointers to every column of a GameCollection, for bulk copies to and from a snapshot.
+ * * Each array holds count entries; the offsets point into name_arena.
+ */
+struct GameColumns
+{
+        size_t               count              = 0;
+        const int*           app_ids            = nullptr;
+        const int*           playtimes          = nullptr;
+        const std::uint32_t* name_offsets       = nullptr;
+        const std::uint32_t* name_lengths       = nullptr;
+        const std::uint32_t* lower_name_offsets = nullptr;
+        const std::uint32_t* lower_name_lengths = nullptr;
+        std::string_view     name_arena;
+};
+
+/**
+ * @brief Struct-of-arrays storage for the fetched game library.
+ * * AppIDs and playtimes live in contiguous columns. Display names and their precomputed lowercase keys share
+ * * one string arena, so sorting and scanning never allocate or call ToLower. The columns can also be
+ * * borrowed from a mapped snapshot (BorrowColumns); the first change then copies them.
+ */
+class GameCollection
+{
+      public:
+        size_t size() const
+        {
+                return app_ids_.size();
+        }
+        bool empty() const
+        {
+                return app_ids_.empty();
+        }
+
+        /* * Drops every game but keeps the reserved capacity for the next rebuild. */
+        void clear();
+
+        /**
+         * @brief Reserves room for a rebuild of known size.
+         * @param game_count Expected number of games.
+         * @param name_bytes Expected total length of all display names.
+         */
+        void reserve(size_t game_count, size_t name_bytes = 0);
+
+        /**
+         * @brief Appends a game, storing its display name and lowercase key in the arena.
+         * @param game The game to copy into the collection.
+         */
+        void push_back(const GameData& game);
+
+        /* * Removes the last game; its name bytes are reclaimed by the next arena compaction. */
+        void pop_back();
+
+        /**
+         * @brief Overwrites the game stored at an index.
+         * * The new name is appended to the arena and the old bytes become garbage; the arena is compacted
+         * * once garbage outweighs live bytes, so repeated updates cannot grow it without bound.
+         * @param index Position of the game to replace.
+         * @param game The new contents.
+         */
+        void Assign(size_t index, const GameData& game);
+
+        /**
+         * @brief Replaces every game with columns copied verbatim, e.g. from a mapped snapshot.
+         * * No name is lowered again; the caller guarantees every offset and length lies inside the arena.
+         */
+        void AssignColumns(const GameColumns& columns);
+
+        /**
+         * @brief Replaces every game with columns read in place, without copying them.
+         * * The memory behind columns must outlive the collection's use of it or the next modification,
+         * * which copies the columns first. Checked like AssignColumns.
+         */
+        void BorrowColumns(const GameColumns& columns);
+
+        /* * True while the columns are read from borrowed memory rather than owned. */
+        bool IsBorrowed() const
+        {
+                return app_ids_.IsBorrowed();
+        }
+
+        /* * Views of the columns, valid until the next modification. */
+        GameColumns Columns() const;
+
+        void SetPlaytime(size_t index, int playtime_forever)
+        {
+                playtimes_[index] = playtime_forever;
+                ++playtime_version_; /* * Name order does not depend on playtime */
+        }
+
+        /* * Bumped by every modification; cached orderings are valid only for the version they were built at. */
+        std::uint64_t Version() const
+        {
+                return names_version_ + playtime_version_;
+        }
+
+        /**
+         * @brief All game indices ordered by lowercase name, ties by index.
+         * * Sorted on first use after a modification and cached until the next one; SetPlaytime keeps it.
+         */
+        const std::vector<size_t>& NameOrder() const;
+
+        /**
+         * @brief All game indices ordered by playtime (most played first), ties in NameOrder.
+         * * Built from NameOrder with a stable radix sort on the playtime column, cached until any modification.
+         */
+        const std::vector<size_t>& PlaytimeOrder() const;
+
+        GameView operator[](size_t index) const
+        {
+                return { Name(index), LowerName(index), app_ids_[index], playtimes_[index] };
+        }
+
+        std::string_view Name(size_t index) const
+        {
+                return { name_arena_.data() + name_offsets_[index], name_lengths_[index] };
+        }
+        std::string_view LowerName(size_t index) const
+        {
+                return { name_arena_.data() + lower_name_offsets_[index], lower_name_lengths_[index] };
+        }
+        int AppId(size_t index) const
+        {
+                return app_ids_[index];
+        }
+        int Playtime(size_t index) const
+        {
+                return playtimes_[index];
+        }
+
+        /* * Raw column access for scans that only need one field. */
+        const SharedArray<int>& AppIdColumn() const
+        {
+                return app_ids_;
+        }
+        const SharedArray<int>& PlaytimeColumn() const
+        {
+                return playtimes_;
+        }
+
+      private:
+        /* * Arena bytes used by a game: its display name plus its lowercase key when stored separately. */
+        size_t NameBytes(size_t index) const
+        {
+                return name_lengths_[index]
+                       + (lower_name_offsets_[index] == name_offsets_[index] ? 0 : lower_name_lengths_[index]);
+        }
+
+        /* * Stores a name and its lowercase key at the end of the arena, filling in the offsets of one game. */
+        void AppendName(size_t index, const std::string& name);
+
+        /* * Rewrites the arena with only the live names once garbage outweighs them. */
+        void CompactNamesIfSparse();
+
+        SharedArray<int>           app_ids_;
+        SharedArray<int>           playtimes_;
+        SharedArray<std::uint32_t> name_offsets_;
+        SharedArray<std::uint32_t> name_lengths_;
+        /* * Equal to name_offsets_ when the display name is already lowercase. */
+        SharedArray<std::uint32_t> lower_name_offsets_;
+        SharedArray<std::uint32_t> lower_name_lengths_;
+        SharedArray<char>          name_arena_;
+        size_t                     garbage_name_bytes_ = 0; /* * Arena bytes no game refers to any more */
+
+        std::uint64_t               names_version_    = 0; /* * Bumped by changes to membership or names */
+        std::uint64_t               playtime_version_ = 0; /* * Bumped by SetPlaytime */
+        mutable std::vector<size_t> name_order_;
+        mutable std::uint64_t       name_order_version_ = ~std::uint64_t{ 0 };
+        mutable std::vector<size_t> playtime_order_;
+        mutable std::uint64_t       playtime_order_names_version_ = ~std::uint64_t{ 0 };
+        mutable std::uint64_t       playtime_order_version_       = ~std::uint64_t{ 0 };
+};
 } // namespace data
 
 namespace data {
@@ -54,6 +252,26 @@ const std::string kDataDirectory         = "data";
  * /// Default filename for storing fetched game data. */
 const std::string kGamesDataJsonFile     = "games.json";
 
+/*
+ * /// Default filename for the pointer to the binary games snapshot (games.<version>.bin). */
+const std::string kGamesSnapshotFile     = "games.bin";
+
+/*
+ * /// Default base filename for the saved search indexes (index.<version>.bin).  */
+const std::string kIndexSnapshotFile     = "index.bin";
+
+/*
+ * /// Default filename for every fetched profile.     */
+const std::string kProfileStoreFile      = "profiles.bin";
+
+/*
+ * /// Default filename for the playtime time series.   */
+const std::string kPlaytimeHistoryFile   = "playtime.bin";
+
+/*
+ * /// Default filename for cached API key checks.     */
+const std::string kApiKeyCacheFile       = "api_keys.cache";
+
 /*
  * /// Default directory for exported CSV files.       */
 const std::string kExportedDataDirectory = "exported";
@@ -66,16 +284,40 @@ const size_t kMaxCommandHistorySize      = 20; /*
 const int kDefaultHistoryDisplayCount    = 10; /*
                                        ! = Default number of commands to show */
 
+const size_t kFuzzySearchResultLimit     = 10; /*
+                                       ! = Max matches shown by fuzzy search  */
+
+const size_t kProfileTopGameCount        = 5; /*
+                                       ! = Most played games in profile info  */
+
+const int kDefaultTrendDays              = 7; /*
+                                       ! = Default days covered by trend      */
+
+const size_t kTrendResultLimit           = 10; /*
+                                       ! = Max games listed by trend          */
+
+const int kApiKeyCacheHours              = 24; /*
+                                       ! = Hours an API key check is trusted  */
+
+const size_t kFetchDiffLineLimit         = 10; /*
+                                       ! = Changes listed per kind by fetch   */
+
+const size_t kPlayerSummaryBatchSize     = 100; /*
+                                       ! = SteamIDs per GetPlayerSummaries    */
+
 /*
  * /// Global variable that check fetched as boolean.        */
 extern bool steam_has_fetched_data;
+/*
+ * /// Set by STEAM_READ_ONLY=1: serve a shared snapshot, never write. */
+extern bool steam_read_only;
 /*
  * /// Global variable storing the Steam API key.            */
 extern std::string steam_api_key;
 
 /*
- * /// Global vector storing the list of fetched games.      */
-extern std::vector<data::GameData> steam_game_collection;
+ * /// Global columnar collection storing the fetched games. */
+extern data::GameCollection steam_game_collection;
 
 /*
  * /// Global object storing the current user's information. */
@@ -11,14 +11,40 @@ STEAM_BEGIN_NAMESPACE
 namespace graph {
 // Adjacency list for game relations (appid -> set of related appids)
 extern std::unordered_map<int, std::unordered_set<int>> steam_game_relations_graph;
-const std::string                                       kRelationsJsonFile = "relations.json";
+const std::string                                       kRelationsJsonFile    = "relations.json";
+const std::string                                       kRelationsJournalFile = "relations.log";
+const size_t kRelationsCompactMinRecords = 4096; // Journal length below which it is never compacted
+
+// Edits recorded in the relations journal, one "+ id1 id2" or "- id1 id2" line each
+enum class RelationEdit
+{
+        ADD,
+        REMOVE,
+};
+
+// One journal line: an edge set or cleared
+struct RelationRecord
+{
+        RelationEdit edit;
+        int          app_id1;
+        int          app_id2;
+};
 
 void                  AddRelation(int app_id1, int app_id2);
 void                  RemoveRelation(int app_id1, int app_id2); // Added for undo functionality
 std::vector<int>      GetRelatedGames(int app_id, int max_recommendations = 5);
 std::filesystem::path GetRelationsDataPath();
-void                  LoadRelations(); // Load from a file (e.g., data/relations.json)
-void                  SaveRelations(); // Save to a file
+std::filesystem::path GetRelationsJournalPath();
+void LoadRelations(); // Load data/relations.json, then replay data/relations.log on top of it
+void SaveRelations(); // Compact: queue the whole graph for relations.json, which empties the journal once written
+// Apply one edit to the graph and queue it for the journal (loader::QueueRelationEdit); constant cost,
+// independent of graph size. Edits to the same pair coalesce until the save worker writes them, and a pair
+// left as it was on disk is not written at all. Once the edits since the last compaction outgrow twice the
+// edge count (and kRelationsCompactMinRecords) the graph is compacted with SaveRelations.
+void EditRelation(RelationEdit edit, int app_id1, int app_id2);
+// Called by the save worker, which never touches the graph itself; they print nothing, the worker reports failures:
+bool AppendRelationRecords(const std::vector<RelationRecord>& records); // One append and one fsync for all
+bool WriteRelationsFile(const std::string& text); // Replace relations.json atomically, then empty the journal
 } // namespace graph
 STEAM_END_NAMESPACE
 
@@ -1,11 +1,18 @@
 #ifndef STEAM_HANDLER_HPP
 #define STEAM_HANDLER_HPP
 
+#include "api_client.hpp"
+#include "catalog.hpp"
 #include "data.hpp"
 #include "graph.hpp"
+#include "history.hpp"
+#include "infix.hpp"
 #include "loader.hpp"
 #include "prefix.hpp"
 #include "process.hpp"
+#include "profile.hpp"
+#include "snapshot.hpp"
+#include "token.hpp"
 #include "undo.hpp"
 #include "utility.hpp"
 
@@ -21,12 +28,48 @@ namespace handler {
  */
 bool FetchGamesFromSteamApi(const std::string& steam_id_or_vanity_url);
 
+/**
+ * @brief Fetches many accounts at once and stores each in the profile store.
+ * * Vanity names are resolved concurrently, summaries are requested kPlayerSummaryBatchSize SteamIDs at a
+ * * time, and owned games are streamed over up to api_client::PoolSize() parallel connections. Each account
+ * * prints a progress line when it is stored or fails. The current library only changes if its own account
+ * * is among them, and then as a diff like a re-fetch.
+ * @param arguments SteamID64s, vanity names, or files listing them (one or more per line, '#' comments).
+ */
+void HandleFetchManyCommand(const std::vector<std::string>& arguments);
+
 /**
  * @brief Searches for games using the prefix tree and prints the results.
  * @param name_prefix The prefix of the game name to search for.
  */
 void HandleSearchCommand(const std::string& name_prefix);
 
+/**
+ * @brief Prints the best-ranked games whose names start with a prefix.
+ * @param name_prefix The prefix of the game name to search for (may be empty for the whole library).
+ * @param count Maximum number of games to show.
+ * @param rank prefix::SearchRank::PLAYTIME (most played first) or prefix::SearchRank::NAME.
+ */
+void HandleTopSearchCommand(const std::string& name_prefix, size_t count, prefix::SearchRank rank);
+
+/**
+ * @brief Typo-tolerant search; prints the closest matches by edit distance.
+ * @param search_term The (possibly misspelled) name or name fragment to look for.
+ */
+void HandleFuzzySearchCommand(const std::string& search_term);
+
+/**
+ * @brief Searches for games whose names contain a piece of text anywhere, using the infix index.
+ * @param search_text The text to look for (case-insensitive).
+ */
+void HandleContainsSearchCommand(const std::string& search_text);
+
+/**
+ * @brief Searches for games containing every given word, in any order, using the word index.
+ * @param words The query words; each matches a name word it equals or starts.
+ */
+void HandleWordSearchCommand(const std::vector<std::string>& words);
+
 /**
  * @brief Counts and prints the number of games that have been played (playtime >
  * 0).
@@ -50,6 +93,34 @@ void HandleExportToCsvCommand(const std::string& output_filename);
  */
 void HandleListGamesCommand(char list_format = ' ');
 
+/**
+ * @brief Prints size and memory statistics for the loaded library and its search index.
+ */
+void HandleStatsCommand();
+
+/**
+ * @brief Lists every profile in profile::steam_profile_store with its game count and total hours.
+ */
+void HandleProfilesCommand();
+
+/**
+ * @brief Makes a stored profile the current library without refetching it.
+ * @param steam_id_or_username The profile's SteamID64, or its username (case-insensitive).
+ */
+void HandleProfileSwitchCommand(const std::string& steam_id_or_username);
+
+/**
+ * @brief Prints a stored profile's account details, totals and most played games.
+ * @param steam_id_or_username The profile's SteamID64, or its username (case-insensitive).
+ */
+void HandleProfileInfoCommand(const std::string& steam_id_or_username);
+
+/**
+ * @brief Lists the stored profiles that own a game, with their playtime.
+ * @param game_identifier An AppID, or a full game name (case-insensitive).
+ */
+void HandleProfileOwnersCommand(const std::string& game_identifier);
+
 /**
  * @brief Displays help information, including available commands and current
  * user data if fetched.
@@ -60,9 +131,13 @@ void ShowHelp();
  * @brief Resolves a game identifier (name, prefix, or AppID) to an AppID.
  * @param identifier The game identifier string.
  * @param found_game_name Optional output parameter to store the resolved game's name.
+ * @param accept_closest_match Whether a unique closest typo-tolerant match is taken without confirmation.
+ * Commands that change data leave it false, so a misspelling lists the candidates instead.
  * @return The AppID if found, otherwise 0.
  */
-int ResolveGameToAppId(const std::string& identifier, std::string* found_game_name = nullptr);
+int ResolveGameToAppId(const std::string& identifier,
+                       std::string*       found_game_name      = nullptr,
+                       bool               accept_closest_match = false);
 
 /**
  * @brief Handles the 'relate' command to create a relationship between two games.
@@ -82,6 +157,18 @@ void HandleRecommendationsCommand(const std::string& game_id_str);
  */
 void HandleUndoCommand();
 
+/**
+ * @brief Writes every change still waiting out the save debounce now, and reports how many files that took.
+ */
+void HandleSaveCommand();
+
+/**
+ * @brief Prints how the current account's playtime changed over recent fetches, most gained first.
+ * @param days Length of the window, ending now.
+ * @param count Maximum number of games to list.
+ */
+void HandleTrendCommand(int days, size_t count);
+
 } // namespace handler
 
 STEAM_END_NAMESPACE
@@ -0,0 +1,60 @@
+#ifndef STEAM_HISTORY_HPP
+#define STEAM_HISTORY_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "data.hpp"
+
+STEAM_BEGIN_NAMESPACE
+/**
+ * @brief Append-only time series of every account's playtimes, one snapshot per fetch.
+ * * Each snapshot is a fixed-size record header (SteamID, time, sizes, payload checksum) followed by only
+ * * the games whose playtime changed since the account's previous snapshot, as varint AppID gaps and
+ * * zigzag varint playtime deltas. An account's first snapshot is a baseline against zero. The change
+ * * over a time window is the sum of the deltas recorded inside it, so a query reads every header but
+ * * decodes only the snapshots of that account within the window.
+ */
+namespace history {
+
+/* * Playtime gained (or, rarely, lost) by one game, in minutes. */
+struct PlaytimeChange
+{
+        int app_id;
+        int minutes;
+};
+
+/* * Result of ComputePlaytimeTrend. */
+struct PlaytimeTrend
+{
+        size_t                      snapshots     = 0;  /* * Delta snapshots inside the window */
+        std::int64_t                first_time    = 0;  /* * Unix time of the earliest of them */
+        std::int64_t                last_time     = 0;  /* * Unix time of the latest of them */
+        std::int64_t                history_start = -1; /* * Time of the account's baseline if inside the window */
+        std::int64_t                span_start    = -1; /* * Time the first of them counts from; may precede the window */
+        std::vector<PlaytimeChange> changes;            /* * Games that changed, largest gain first */
+};
+
+/**
+ * @brief Appends the playtimes of a freshly fetched library as the account's next snapshot.
+ * * The account's previous playtimes are rebuilt from its own snapshots only. A record torn by a crash
+ * * at the end of the file is cut off first.
+ * @param steam_id The account's SteamID64; other values are not recorded.
+ * @param games The fetched library.
+ * @param timestamp Unix time of the fetch.
+ * @return False if the file could not be written.
+ */
+bool AppendPlaytimeSnapshot(const std::string& steam_id, const data::GameCollection& games, std::int64_t timestamp);
+
+/**
+ * @brief Sums an account's playtime deltas over the snapshots taken in (from, to].
+ * * The account's baseline is skipped: it holds lifetime totals rather than a change. The first delta
+ * * covers everything since the account's previous snapshot, so span_start reports when that was.
+ * @return False if the history file is missing or the SteamID is not a SteamID64.
+ */
+bool ComputePlaytimeTrend(const std::string& steam_id, std::int64_t from, std::int64_t to, PlaytimeTrend& trend);
+} // namespace history
+STEAM_END_NAMESPACE
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef STEAM_INFIX_HPP
+#define STEAM_INFIX_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "data.hpp"
+
+STEAM_BEGIN_NAMESPACE
+namespace infix {
+
+/**
+ * @brief Trigram posting index for "name contains" searches.
+ * * Every distinct 3-byte window of a lowercase name maps to the sorted list of games containing it.
+ * * A query intersects the lists of its own trigrams, starting with the rarest, and confirms the few
+ * * surviving candidates with a substring check, so the cost follows the rarest trigram instead of the
+ * * library size. Queries shorter than a trigram fall back to scanning the lowercase names.
+ * * The lists can also be borrowed from a mapped index file (Borrow) and are copied only on the first change.
+ */
+struct InfixIndex
+{
+        static constexpr size_t kGramLength = 3;
+
+        std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> postings_; /* * Trigram -> game indices */
+
+        /* * Used instead of postings_ while borrowed: ascending trigrams, list i is
+         * * borrowed_postings_[borrowed_offsets_[i], borrowed_offsets_[i + 1]). */
+        ArrayView<std::uint32_t> borrowed_grams_;
+        ArrayView<std::uint32_t> borrowed_offsets_;
+        ArrayView<std::uint32_t> borrowed_postings_;
+
+        /* * Clears all posting lists. */
+        void Clear()
+        {
+                postings_.clear();
+                borrowed_grams_    = {};
+                borrowed_offsets_  = {};
+                borrowed_postings_ = {};
+        }
+
+        /**
+         * @brief Replaces the index with posting lists read in place, e.g. from a mapped index file.
+         * @param grams Trigram keys in ascending order.
+         * @param offsets grams.size + 1 ascending offsets into postings.
+         * @param postings Every list, each sorted by game index.
+         */
+        void Borrow(ArrayView<std::uint32_t> grams, ArrayView<std::uint32_t> offsets, ArrayView<std::uint32_t> postings);
+
+        bool IsBorrowed() const
+        {
+                return borrowed_offsets_.size > 0;
+        }
+
+        /* * Copies borrowed lists into postings_, so they can be changed; Insert and Erase call it first. */
+        void TakeOwnership();
+
+        /**
+         * @brief Adds a game's trigrams to the index.
+         * @param lower_name The lowercase name of the game.
+         * @param game_index The index of the game in steam_game_collection.
+         * @return Posting list entries added.
+         */
+        size_t Insert(std::string_view lower_name, size_t game_index);
+
+        /**
+         * @brief Removes a game from the posting lists of its trigrams; lists left empty are dropped.
+         * @param lower_name The lowercase name the game was inserted under.
+         * @param game_index The index the game was inserted with.
+         * @return Posting list entries removed.
+         */
+        size_t Erase(std::string_view lower_name, size_t game_index);
+
+        /**
+         * @brief Finds games whose names contain the given text, ignoring case.
+         * @param text The substring to search for.
+         * @return Indices into steam_game_collection, ordered by lowercase name.
+         */
+        std::vector<size_t> SearchContaining(const std::string& text) const;
+
+        size_t GramCount() const
+        {
+                return IsBorrowed() ? borrowed_grams_.size : postings_.size();
+        }
+
+        /**
+         * @brief Approximate bytes held by the posting lists and the hash table; borrowed lists count as 0.
+         */
+        size_t MemoryUsage() const;
+
+      private:
+        /* * The sorted games containing a trigram; empty if none does. */
+        ArrayView<std::uint32_t> Posting(std::uint32_t gram) const;
+
+        static std::uint32_t GramKey(const char* gram)
+        {
+                return static_cast<std::uint32_t>(static_cast<unsigned char>(gram[0])) << 16
+                       | static_cast<std::uint32_t>(static_cast<unsigned char>(gram[1])) << 8
+                       | static_cast<std::uint32_t>(static_cast<unsigned char>(gram[2]));
+        }
+};
+
+/* * Global infix index over steam_game_collection's lowercase names. */
+extern InfixIndex steam_game_name_infix_index;
+} // namespace infix
+STEAM_END_NAMESPACE
+
+#endif
@@ -1,23 +1,162 @@
 #ifndef STEAM_LOADER_HPP
 #define STEAM_LOADER_HPP
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
 #include "api_key.hpp"
 #include "data.hpp"
+#include "graph.hpp"
 
 STEAM_BEGIN_NAMESPACE
 
 namespace loader {
 
+/* * Layouts WriteGamesJson can produce. */
+enum class JsonStyle
+{
+        PRETTY,  /* * Four-space indentation, as nlohmann::json::dump(4) writes it */
+        COMPACT, /* * No whitespace at all */
+};
+
+/* * Layout used for games.json; COMPACT when StartLoadingData finds STEAM_COMPACT_JSON=1 in the environment or .env. */
+extern JsonStyle steam_games_json_style;
+
+/**
+ * @brief Streams game and user data as JSON straight from the collection, without building a document.
+ * @return False if writing to the file failed.
+ */
+bool WriteGamesJson(std::FILE*                  file,
+                    const data::GameCollection& games,
+                    const data::UserData&       user,
+                    JsonStyle                   style);
+
+/* * Queued changes are written once no other change has been queued for this long... */
+const std::chrono::milliseconds kSaveQuietTime(1000);
+/* * ...or once the oldest unwritten change has waited this long, so a steady stream of edits still lands. */
+const std::chrono::milliseconds kSaveMaxDelay(5000);
+
+/* * The files the save worker keeps up to date, each with its own dirty flag and version counter. */
+enum class Store
+{
+        LIBRARY,   /* * games.json, the games snapshot and its index file */
+        PROFILES,  /* * The profile store */
+        RELATIONS, /* * relations.json and relations.log */
+        COUNT,
+};
+
+/* * Counts the changes queued for a store and the ones written; the store is dirty while they differ. */
+struct StoreVersion
+{
+        std::uint64_t changed = 0;
+        std::uint64_t saved   = 0;
+
+        bool Dirty() const
+        {
+                return changed != saved;
+        }
+};
+
+/* * Files the save worker has written, left alone because they already held the same content, or failed to write. */
+struct SaveCounts
+{
+        size_t written   = 0;
+        size_t unchanged = 0;
+        size_t failed    = 0; /* * Writes that failed; their store stays dirty and is retried */
+};
+
+/**
+ * @brief Locks the library, its indexes and the profile store against the save worker, which encodes them.
+ * * The main thread holds it while a command runs and the loader while it fills them. FlushPendingSaves waits
+ * * on the worker, so it must not be called with this lock held.
+ */
+std::unique_lock<std::mutex> LockData();
+
+/**
+ * @brief Saves the game and user data as JSON and as the binary snapshot, plus the search indexes and the
+ * * current profile.
+ * * Returns at once: it flags the library dirty, and re-stores the current profile and flags the profile store
+ * * only if the library or account changed since it was last stored. After the kSaveQuietTime / kSaveMaxDelay
+ * * debounce, a background thread encodes each dirty store once, from the state at that moment and under
+ * * LockData, then writes games.json and the snapshot files, each through WriteFileAtomically. A file whose
+ * * header shows it already holds the same content is not rewritten.
+ */
+void SaveGamesData();
+
+/* * Flags the profile store dirty after profiles other than the current one were stored. */
+void SaveProfileStore();
+
+/**
+ * @brief Queues one relation edit for relations.log.
+ * * Edits to the same pair coalesce until the worker writes them; a pair that ends as it was (was_set) is
+ * * dropped, and the rest are appended with one write and one fsync.
+ */
+void QueueRelationEdit(const graph::RelationRecord& record, bool was_set);
+
+/* * Queues a compacted relations.json; edits queued before it are already in it and are dropped. */
+void QueueRelationsFile(std::string text);
+
+/* * Writes every queued change now, without waiting out the debounce, and blocks until it is on disk. */
+void FlushPendingSaves();
+
+StoreVersion GetStoreVersion(Store store);
+SaveCounts   GetSaveCounts();
+
+/**
+ * @brief Prints the writes the save worker has seen fail since the last call.
+ * * The worker only collects them, so nothing is printed from its thread in the middle of the prompt; the
+ * * main loop calls this before each prompt. A write that keeps failing is listed once per call.
+ */
+void ReportSaveFailures();
+
+/**
+ * @brief Starts loading on background threads and returns at once, so the prompt opens immediately.
+ * * Reads .env, STEAM_COMPACT_JSON, STEAM_HTTP_POOL_SIZE, STEAM_HTTP_IDLE_SECONDS and STEAM_READ_ONLY
+ * * first, then validates the API key (a network call), runs LoadGamesData and runs graph::LoadRelations as
+ * * three independent tasks. A read-only process skips the API key.
+ */
+void StartLoadingData();
+
+/**
+ * @brief In a read-only process, picks up a snapshot or relations a writer has published since the last load.
+ * * Costs a pointer read and two file stats when nothing changed. Runs on the main thread before each command.
+ * * Only the library is mapped and shared; the relations are reparsed into this process when they change.
+ */
+void ReloadPublishedData();
+
+/**
+ * @brief Blocks until LoadGamesData and graph::LoadRelations have finished; returns at once afterwards.
+ * * Every command that reads or changes the library or the relations calls this first.
+ */
+void WaitUntilDataLoaded();
+
+/* * True once the library and relations are loaded, without waiting. */
+bool IsDataLoaded();
+
+/* * Blocks until the API key from the environment or .env has been checked. */
+void WaitUntilApiKeyChecked();
+
+/**
+ * @brief Asks on the console for an API key until a valid one is entered or the user types 'skip'.
+ * * A valid key is appended to .env. Runs on the main thread, when 'fetch' finds no key.
+ * @return True if steam_api_key now holds a valid key.
+ */
+bool PromptForApiKey();
+
 /**
- * @brief Saves the currently fetched game and user data to a JSON file.
- * * The data is saved to a file specified by GetGamesDataPath().
+ * @brief Loads game and user data.
+ * * The binary snapshot from GetGamesSnapshotPath() is mapped when it is valid and not older than
+ * * games.json, and the search indexes saved with it are reused when they match it; otherwise games.json
+ * * is imported and a fresh snapshot written from it. A read-only process shares the snapshot and its
+ * * indexes through snapshot::ShareGamesSnapshot instead, and never writes.
  */
-void SaveGamesDataToJson();
+void LoadGamesData();
 
 /**
- * @brief Loads game and user data from a JSON file.
- * * Also attempts to load the API key.
+ * @brief Imports game and user data from the JSON file at GetGamesDataPath().
+ * @return False if the file is missing or cannot be parsed.
  */
-void LoadGamesDataFromJson();
+bool LoadGamesDataFromJson();
 } // namespace loader
 
 STEAM_END_NAMESPACE
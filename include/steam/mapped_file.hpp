@@ -0,0 +1,53 @@
+#ifndef STEAM_MAPPED_FILE_HPP
+#define STEAM_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include "base.hpp"
+
+STEAM_BEGIN_NAMESPACE
+/**
+ * @brief Read-only memory mapping of a whole file.
+ * * Uses mmap on POSIX and a file mapping object on Windows. Pages are loaded by the OS on first touch,
+ * * so opening a large file costs a system call rather than a read of its contents.
+ */
+class MappedFile
+{
+      public:
+        MappedFile() = default;
+        ~MappedFile()
+        {
+                Close();
+        }
+        MappedFile(const MappedFile&)            = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @brief Maps a file, replacing any mapping already held.
+         * @return False if the file is missing, empty or cannot be mapped.
+         */
+        bool Open(const std::filesystem::path& path);
+
+        /* * Unmaps the file; data() is nullptr afterwards. */
+        void Close();
+
+        const char* data() const
+        {
+                return data_;
+        }
+        size_t size() const
+        {
+                return size_;
+        }
+
+      private:
+        const char* data_ = nullptr;
+        size_t      size_ = 0;
+#ifdef _WIN32
+        void* file_handle_    = nullptr;
+        void* mapping_handle_ = nullptr;
+#endif
+};
+STEAM_END_NAMESPACE
+
+#endif
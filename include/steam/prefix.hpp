@@ -2,6 +2,8 @@
 #define STEAM_DATA_PREFIX_HPP
 
 #include <algorithm> // For std::sort
+#include <cstdint>
+#include <limits>
 #include <unordered_map>
 #include <vector> // For std::vector
 #include "data.hpp"
@@ -10,54 +12,84 @@
 STEAM_BEGIN_NAMESPACE
 namespace prefix {
 
+/* * Orderings supported by PrefixTree::TopByPrefix. */
+enum class SearchRank
+{
+        PLAYTIME, /* * Most played first, ties broken by name */
+        NAME,     /* * Alphabetical by lowercase name */
+};
+
+/* * One result of PrefixTree::FuzzySearch. */
+struct FuzzyMatch
+{
+        size_t        game_index;    /* * Index into steam_game_collection */
+        std::uint32_t distance;      /* * Edit distance between the query and the best-matching name fragment */
+        std::uint32_t name_distance; /* * Edit distance to the whole name, ignoring separators (tie-breaker) */
+};
+
 /**
- * @brief Structure for a prefix tree (Trie) to enable efficient prefix - based* game name searches.*/
+ * @brief Structure for a prefix tree (Trie) to enable efficient prefix - based* game name searches.
+ * * Radix (Patricia) compressed: each node owns an edge label of one or more characters.
+ * * Nodes, label bytes and stored game indices live in three contiguous arrays and refer to
+ * * each other by 32-bit index, so the whole tree is three allocations regardless of size.
+ * * Nodes whose subtree holds more than kTopCacheSize games also cache their top kTopCacheSize games
+ * * by playtime (read from steam_game_collection), so ranked searches never walk the subtree.
+ * * Erase keeps the tree compressed by dropping empty leaves and merging single-child chains; freed nodes,
+ * * value entries and cache slots are recycled by later insertions, and orphaned label bytes are compacted
+ * * away once they make up half the label arena.
+ * * The node, value, label and cache arrays can borrow a mapped index file; the first change copies them.
+ */
 struct PrefixTree
 {
+        static constexpr std::uint32_t kNone               = std::numeric_limits<std::uint32_t>::max();
+        static constexpr std::uint32_t kTopCacheSize       = 16;
+        static constexpr size_t        kMinLabelCompaction = 64 * 1024; /* * Dead label bytes worth compacting */
+
         struct Node
         {
-                std::unordered_map<char, Node*> children;
-                std::vector<size_t>             game_indices; /* * Indices into steam_game_collection */
-
-                Node()                       = default;
-
-                /* ! Non-copyable and non-movable to simplify memory management. */
-                Node(const Node&)            = delete;
-                Node& operator=(const Node&) = delete;
-                Node(Node&&)                 = delete;
-                Node& operator=(Node&&)      = delete;
-
-                ~Node()
-                {
-                        /* * Recursively delete child nodes. */
-                        /* * This is a simple destructor; for complex scenarios, consider smart pointers. */
-                        for (auto& pair : children) {
-                                delete pair.second;
-                        }
-                }
+                std::uint32_t label_offset = 0;     /* * Edge label start in label_arena_ */
+                std::uint32_t label_length = 0;
+                std::uint32_t first_child  = kNone; /* * Children are kept sorted by their first label byte */
+                std::uint32_t next_sibling = kNone;
+                std::uint32_t first_value  = kNone; /* * Head of this node's list in value_entries_ */
+                std::uint32_t subtree_size = 0;     /* * Games stored at or below this node */
+                std::uint32_t top_slot     = kNone; /* * Cache slot in top_by_playtime_, set once subtree_size > K */
         };
 
-        Node* root_node_;
-
-        PrefixTree() : root_node_(new Node())
+        struct ValueEntry
         {
-        }
+                std::uint32_t game_index; /* * Index into steam_game_collection */
+                std::uint32_t next;
+        };
 
-        ~PrefixTree()
+        SharedArray<Node>          nodes_; /* * nodes_[0] is the root and has an empty label */
+        SharedArray<ValueEntry>    value_entries_;
+        SharedArray<char>          label_arena_;
+        SharedArray<std::uint32_t> top_by_playtime_; /* * kTopCacheSize indices per cache slot, best first */
+        std::vector<std::uint32_t> free_nodes_;      /* * Unlinked entries of nodes_ */
+        std::vector<std::uint32_t> free_values_;     /* * Unlinked entries of value_entries_ */
+        std::vector<std::uint32_t> free_top_slots_;  /* * Released cache slots in top_by_playtime_ */
+        size_t                     dead_label_bytes_ = 0; /* * Bytes of label_arena_ no node refers to */
+
+        PrefixTree()
         {
-                delete root_node_; /* * This will trigger recursive deletion if Node's destructor is correctly
-                                      implemented. */
-                root_node_ = nullptr;
+                nodes_.emplace_back();
         }
 
         /* * Clears all nodes in the prefix tree.
-         * ? Is explicitly calling Clear necessary if destructor handles it?
-         * * It can be useful for re-initializing without destruction/reconstruction.
+         * * O(1): the arrays hold trivially destructible entries and keep their capacity for the rebuild.
          */
         void Clear()
         {
-                delete root_node_;
-                root_node_ = new Node();
+                nodes_.clear();
+                value_entries_.clear();
+                label_arena_.clear();
+                top_by_playtime_.clear();
+                free_nodes_.clear();
+                free_values_.clear();
+                free_top_slots_.clear();
+                dead_label_bytes_ = 0;
+                nodes_.emplace_back();
         }
 
         /**
@@ -67,6 +99,38 @@ struct PrefixTree
          */
         void Insert(const std::string& name, size_t game_index);
 
+        /**
+         * @brief Replaces the tree with the first game_count games of steam_game_collection.
+         * * With more than one thread, games are split into contiguous ranges of their first lowercase byte, each
+         * * range is built as its own tree on its own thread, and the trees are concatenated under one root.
+         * * Searches then return exactly what a serial build of the same games returns.
+         * @param game_count Number of games, from index 0, to insert.
+         * @param thread_count Threads to build with; 1 inserts serially.
+         */
+        void InsertAll(size_t game_count, unsigned thread_count);
+
+        /**
+         * @brief Removes one game from the prefix tree.
+         * * Walks only the name's path: subtree sizes and top caches along it are updated, the emptied leaf is
+         * * unlinked, and a parent left with one child and no games is merged with that child.
+         * @param name The name the game was inserted under.
+         * @param game_index The index the game was inserted with.
+         * @return False if the game was not stored under that name.
+         */
+        bool Erase(const std::string& name, size_t game_index);
+
+        /**
+         * @brief Re-ranks one game in the top caches along its name after its playtime changed.
+         * * Call after steam_game_collection holds the new playtime. A cached game moves within each cache, an
+         * * uncached one that now outranks a cache's last entry takes its place, and a node re-ranks from its
+         * * children's caches only when the game sinks to the last slot and may have dropped out.
+         * @param name The name the game was inserted under.
+         * @param game_index The index the game was inserted with.
+         * @param previous_playtime The playtime the caches were ranked with.
+         * @return False if the game was not stored under that name.
+         */
+        bool UpdatePlaytime(const std::string& name, size_t game_index, int previous_playtime);
+
         /**
          * @brief Searches for games whose names start with the given prefix.
          * @param prefix The prefix to search for.
@@ -75,21 +139,151 @@ struct PrefixTree
          */
         std::vector<size_t> SearchByPrefix(const std::string& prefix) const;
 
+        /**
+         * @brief Returns the best-ranked games whose names start with the given prefix.
+         * * Cost depends on count, not on how many games share the prefix, as long as count <= kTopCacheSize
+         * * for PLAYTIME; larger playtime requests fall back to collecting the subtree.
+         * @param prefix The prefix to search for (may be empty).
+         * @param count Maximum number of results.
+         * @param rank Result ordering.
+         * @return Indices into steam_game_collection, best first.
+         */
+        std::vector<size_t> TopByPrefix(const std::string& prefix, size_t count, SearchRank rank) const;
+
+        /**
+         * @brief Typo-tolerant search: a Levenshtein DP row is carried down every edge of the tree.
+         * * A name matches when the query is within max_distance edits of some fragment of the name that starts
+         * * at a word boundary, e.g. "witchr" matches "The Witcher 3" and "portal2" matches "Portal 2".
+         * * Cost is O(label bytes x query length), independent of how many games match.
+         * @param query The text to look for.
+         * @param max_distance Largest accepted edit distance.
+         * @param max_results Maximum number of matches to return.
+         * @return Matches ordered by distance, then name_distance, then playtime.
+         */
+        std::vector<FuzzyMatch>
+        FuzzySearch(const std::string& query, std::uint32_t max_distance, size_t max_results) const;
+
+        /* * Edit distance FuzzySearch callers accept by default: one typo for short queries, two otherwise. */
+        static std::uint32_t DefaultFuzzyDistance(size_t query_length)
+        {
+                return query_length <= 4 ? 1 : 2;
+        }
+
+        size_t NodeCount() const
+        {
+                return nodes_.size() - free_nodes_.size();
+        }
+
+        /**
+         * @brief Bytes reserved by the node, value and label arrays; borrowed arrays count as 0.
+         */
+        size_t MemoryUsage() const
+        {
+                return nodes_.capacity() * sizeof(Node) + value_entries_.capacity() * sizeof(ValueEntry)
+                       + label_arena_.capacity()
+                       + (top_by_playtime_.capacity() + free_nodes_.capacity() + free_values_.capacity()
+                          + free_top_slots_.capacity())
+                             * sizeof(std::uint32_t);
+        }
+
       private:
+        /**
+         * @brief Walks a lowercase prefix down the tree.
+         * @return The highest node whose subtree holds exactly the matching games, or kNone.
+         */
+        std::uint32_t FindPrefixNode(const std::string& lower_prefix) const;
+
+        /**
+         * @brief Walks a whole lowercase name down the tree.
+         * @param path Receives the root and every node on the way, ending at the node the name is stored on.
+         * @return False if no node spells out exactly that name.
+         */
+        bool FindNamePath(const std::string& lower_name, std::vector<std::uint32_t>& path) const;
+
+        /**
+         * @brief Counts a newly inserted game in a node's subtree size and top-playtime cache.
+         */
+        void AddToTopCache(std::uint32_t node_index, std::uint32_t game_index);
+
+        /**
+         * @brief Uncounts an erased game; refills the node's cache if the game was cached.
+         * * Must run after the game's value entry is unlinked and after the caches below the node are updated.
+         */
+        void RemoveFromTopCache(std::uint32_t node_index, std::uint32_t game_index);
+
+        /**
+         * @brief Re-ranks a node's cache from its own games and its children's caches.
+         * * Exact as long as every child's cache is, at a cost of O(children x kTopCacheSize) instead of the
+         * * subtree's size.
+         */
+        void RefillTopCache(std::uint32_t node_index);
+
+        /**
+         * @brief Rewrites label_arena_ with only the labels live nodes refer to, in pre-order.
+         * * Erase runs it once dead labels (from freed nodes and merged chains) exceed half the arena.
+         */
+        void CompactLabels();
+
+        /**
+         * @brief Appends trees built over disjoint, ascending first-byte ranges below this (cleared) root.
+         * * Links are shifted by each part's position in the merged arrays; only the root's cache is re-ranked.
+         */
+        void MergePartitions(const std::vector<PrefixTree>& parts);
+
+        /* * Stores a node, reusing a freed slot when there is one. */
+        std::uint32_t AllocateNode(const Node& node);
+
+        /* * Returns a free cache slot of kTopCacheSize entries. */
+        std::uint32_t AllocateTopSlot();
+
+        /**
+         * @brief Folds a node's only child into it, so the node carries the concatenated label.
+         * * Used when an erase leaves a non-root node with no games and a single child.
+         */
+        void MergeWithOnlyChild(std::uint32_t node_index);
+
+        /**
+         * @brief Emits a subtree's games in name order, stopping once indices holds count entries.
+         */
+        void CollectInNameOrder(std::uint32_t node_index, size_t count, std::vector<size_t>& indices) const;
+
+        /* * Scratch state for one FuzzySearch call. */
+        struct FuzzyState;
+
+        /**
+         * @brief Extends the DP rows along one node's label and recurses into its children.
+         */
+        void FuzzySearchRecursive(std::uint32_t node_index, size_t level, FuzzyState& state) const;
+
+        /**
+         * @brief Finds the child of a node whose label starts with a character.
+         * @param previous_sibling Set to the child after which a new child starting with ch belongs.
+         * @return The child's node index, or kNone.
+         */
+        std::uint32_t FindChild(std::uint32_t node_index, char ch, std::uint32_t* previous_sibling = nullptr) const;
+
+        /**
+         * @brief Splits a node's label so that it keeps only its first split_at characters.
+         * * The remainder moves to a new single child that takes over the children and values.
+         */
+        void SplitNode(std::uint32_t node_index, std::uint32_t split_at);
+
         /**
          * @brief Recursively collects all game indices from a given node and its
          * descendants.
-         * @param current_node The current node to process.
+         * @param node_index The current node to process.
          * @param indices A reference to the vector where collected indices will be
          * stored.
          */
-        void CollectGameIndicesRecursive(const Node* current_node, std::vector<size_t>& indices) const;
+        void CollectGameIndicesRecursive(std::uint32_t node_index, std::vector<size_t>& indices) const;
 };
 
 /* * Global prefix tree for game name searching. */
 extern PrefixTree steam_game_name_prefix_tree;
-/* * Global map from lowercase game name to its index in steam_game_collection. */
-extern std::unordered_map<std::string, size_t> steam_game_name_to_index_map;
+/* * Global map from lowercase game name to its index in steam_game_collection; lookups ignore case. */
+extern std::unordered_map<std::string, size_t, IgnoreCaseHash, IgnoreCaseEqual> steam_game_name_to_index_map;
+/* * Global map from AppID to its index in steam_game_collection. */
+extern std::unordered_map<int, size_t> steam_game_app_id_to_index_map;
 } // namespace prefix
 STEAM_END_NAMESPACE
 
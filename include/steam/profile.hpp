@@ -0,0 +1,118 @@
+#ifndef STEAM_PROFILE_HPP
+#define STEAM_PROFILE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "data.hpp"
+
+STEAM_BEGIN_NAMESPACE
+namespace profile {
+
+/* * One stored account: its user data and (app, playtime) pairs referring to ProfileStore's dictionary. */
+struct Profile
+{
+        data::UserData             user;
+        std::vector<std::uint32_t> app_indices; /* * Into the dictionary, in library order */
+        std::vector<int>           playtimes;   /* * Parallel to app_indices */
+};
+
+/**
+ * @brief Libraries of every fetched account, keyed by SteamID.
+ * * AppIDs and names are interned once in a dictionary shared by all profiles, so each profile only keeps
+ * * eight bytes per game no matter how many other accounts own it. steam_game_collection stays the one
+ * * library that searches and listings run on; ActivateProfile copies a stored profile into it.
+ */
+struct ProfileStore
+{
+        static constexpr std::uint32_t kNoApp = std::numeric_limits<std::uint32_t>::max();
+
+        std::vector<int>                       app_ids_;      /* * Dictionary: AppID of each app index */
+        std::vector<std::uint32_t>             name_offsets_; /* * Dictionary: name start in name_arena_ */
+        std::vector<std::uint32_t>             name_lengths_;
+        std::string                            name_arena_;
+        std::unordered_map<int, std::uint32_t> app_index_by_id_;
+        std::map<std::string, Profile>         profiles_;            /* * By SteamID */
+        data::UserData                         current_user_;        /* * Account StoreCurrentProfile last stored */
+        std::uint64_t                          current_version_ = 0; /* * steam_game_collection.Version() then */
+
+        void Clear()
+        {
+                app_ids_.clear();
+                name_offsets_.clear();
+                name_lengths_.clear();
+                name_arena_.clear();
+                app_index_by_id_.clear();
+                profiles_.clear();
+                current_user_ = {};
+        }
+
+        /**
+         * @brief Adds an AppID to the dictionary, or updates its name if Steam renamed the game.
+         * @return The app's dictionary index.
+         */
+        std::uint32_t InternApp(int app_id, std::string_view name);
+
+        /* * Dictionary index of an AppID, or kNoApp. */
+        std::uint32_t FindApp(int app_id) const;
+
+        size_t AppCount() const
+        {
+                return app_ids_.size();
+        }
+        int AppId(std::uint32_t app_index) const
+        {
+                return app_ids_[app_index];
+        }
+        std::string_view AppName(std::uint32_t app_index) const
+        {
+                return { name_arena_.data() + name_offsets_[app_index], name_lengths_[app_index] };
+        }
+
+        /**
+         * @brief Stores (or replaces) a profile with a copy of a library.
+         * @param user The account; its steam_id is the key.
+         * @param games The account's games.
+         */
+        void StoreProfile(const data::UserData& user, const data::GameCollection& games);
+
+        /**
+         * @brief Stores steam_game_collection as steam_current_user_data's profile unless it already is.
+         * * Skipped when the account, its user data and steam_game_collection.Version() are what the last call
+         * * (or MarkCurrentStored) saw, so saving an unchanged library does not re-encode it.
+         * @return True if the profile was stored.
+         */
+        bool StoreCurrentProfile();
+
+        /* * Records that the stored profile of steam_current_user_data already matches steam_game_collection. */
+        void MarkCurrentStored();
+
+        /**
+         * @brief Finds a profile by SteamID, or else by username ignoring case.
+         * @return nullptr if no stored profile matches.
+         */
+        const Profile* FindProfile(const std::string& steam_id_or_username) const;
+
+        /**
+         * @brief Approximate bytes held by the dictionary and the per-profile arrays.
+         */
+        size_t MemoryUsage() const;
+};
+
+/**
+ * @brief Makes a stored profile the current library without refetching it.
+ * * Rebuilds steam_game_collection and its indexes through catalog, sets steam_current_user_data and saves.
+ * @return False if the profile is not stored.
+ */
+bool ActivateProfile(const std::string& steam_id_or_username);
+
+/* * Global store of every fetched account. */
+extern ProfileStore steam_profile_store;
+} // namespace profile
+STEAM_END_NAMESPACE
+
+#endif
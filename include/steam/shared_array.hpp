@@ -0,0 +1,163 @@
+#ifndef STEAM_SHARED_ARRAY_HPP
+#define STEAM_SHARED_ARRAY_HPP
+
+#include <cstddef>
+#include <utility> // For std::forward
+#include <vector>
+#include "base.hpp"
+
+STEAM_BEGIN_NAMESPACE
+
+/* * Read-only view of count elements stored elsewhere, e.g. one section of a mapped snapshot. */
+template <typename T> struct ArrayView
+{
+        const T* data = nullptr;
+        size_t   size = 0;
+
+        const T& operator[](size_t index) const
+        {
+                return data[index];
+        }
+        const T* begin() const
+        {
+                return data;
+        }
+        const T* end() const
+        {
+                return data + size;
+        }
+};
+
+/**
+ * @brief Array that either owns its elements or borrows a read-only range it does not own.
+ * * A borrowed array (Borrow) reads straight from memory such as a mapped snapshot, so processes that map
+ * * the same file share its pages instead of each holding a copy. The first non-const access copies the
+ * * borrowed elements into an owned std::vector and the array behaves like that vector from then on, so
+ * * code that changes the array never writes through a borrowed pointer.
+ */
+template <typename T> class SharedArray
+{
+      public:
+        /* * Drops owned elements and reads from [data, data + size) until the next change; nothing is copied. */
+        void Borrow(const T* data, size_t size)
+        {
+                std::vector<T>().swap(owned_);
+                borrowed_      = data;
+                borrowed_size_ = size;
+                is_borrowed_   = true;
+        }
+
+        bool IsBorrowed() const
+        {
+                return is_borrowed_;
+        }
+
+        /* * The owned vector, after copying the borrowed elements into it if needed. */
+        std::vector<T>& Owned()
+        {
+                if (is_borrowed_) {
+                        owned_.assign(borrowed_, borrowed_ + borrowed_size_);
+                        is_borrowed_ = false;
+                }
+                return owned_;
+        }
+
+        size_t size() const
+        {
+                return is_borrowed_ ? borrowed_size_ : owned_.size();
+        }
+        bool empty() const
+        {
+                return size() == 0;
+        }
+        /* * Elements held privately; 0 while borrowed. */
+        size_t capacity() const
+        {
+                return owned_.capacity();
+        }
+
+        const T* data() const
+        {
+                return is_borrowed_ ? borrowed_ : owned_.data();
+        }
+        const T& operator[](size_t index) const
+        {
+                return data()[index];
+        }
+        const T* begin() const
+        {
+                return data();
+        }
+        const T* end() const
+        {
+                return data() + size();
+        }
+
+        T* data()
+        {
+                return Owned().data();
+        }
+        T& operator[](size_t index)
+        {
+                return Owned()[index];
+        }
+        T* begin()
+        {
+                return Owned().data();
+        }
+        T* end()
+        {
+                std::vector<T>& owned = Owned();
+                return owned.data() + owned.size();
+        }
+        T& back()
+        {
+                return Owned().back();
+        }
+
+        void clear()
+        {
+                is_borrowed_ = false;
+                owned_.clear();
+        }
+        void reserve(size_t capacity)
+        {
+                Owned().reserve(capacity);
+        }
+        void resize(size_t size)
+        {
+                Owned().resize(size);
+        }
+        void push_back(const T& value)
+        {
+                Owned().push_back(value);
+        }
+        template <typename... Args> T& emplace_back(Args&&... args)
+        {
+                return Owned().emplace_back(std::forward<Args>(args)...);
+        }
+        void pop_back()
+        {
+                Owned().pop_back();
+        }
+        void assign(const T* first, const T* last)
+        {
+                is_borrowed_ = false;
+                owned_.assign(first, last);
+        }
+        /* * Appends count elements copied from values, which must not point into this array. */
+        void append(const T* values, size_t count)
+        {
+                std::vector<T>& owned = Owned();
+                owned.insert(owned.end(), values, values + count);
+        }
+
+      private:
+        std::vector<T> owned_;
+        const T*       borrowed_      = nullptr;
+        size_t         borrowed_size_ = 0;
+        bool           is_borrowed_   = false;
+};
+STEAM_END_NAMESPACE
+
+#endif
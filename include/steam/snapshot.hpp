@@ -0,0 +1,137 @@
+#ifndef STEAM_SNAPSHOT_HPP
+#define STEAM_SNAPSHOT_HPP
+
+#include <filesystem>
+#include <string>
+#include "data.hpp"
+
+STEAM_BEGIN_NAMESPACE
+/**
+ * @brief Binary snapshots of the game library and of its search indexes, loaded by mapping the files
+ * * instead of parsing them.
+ * * Both files start with a fixed header (magic, format version, byte-order mark, game count, source hash,
+ * * file size, checksum) and a section table, followed by 8-byte-aligned sections. The games file holds
+ * * the user strings, every GameCollection column exactly as it is kept in memory, and the name arena.
+ * * The index file holds the prefix tree's arrays, the name and AppID maps as game indices, and the infix
+ * * and word posting lists; its source hash is the checksum of the games file it was built from, so it is
+ * * only used for exactly that library. games.json stays the import/export format. The profile store file
+ * * uses the same layout for profile::steam_profile_store: its app dictionary, then every profile's user
+ * * strings and (app index, playtime) columns.
+ * * A read-only process can share one games and index file with any number of others (ShareGamesSnapshot):
+ * * the library and its indexes are read where they are mapped, so every process uses the same page cache
+ * * pages. Writers publish each version under its own names, games.<version>.bin and index.<version>.bin,
+ * * where the version is the games file's checksum, and then atomically replace games.bin with a small
+ * * pointer naming it. A versioned file is never replaced once written, so publishing does not rename over
+ * * a file a reader maps, which Windows refuses; files of older versions are deleted once nothing maps
+ * * them. Only replacing the pointer can still fail on Windows, while a reader happens to be reading it;
+ * * the save worker keeps the library queued and retries. A games.bin holding an image itself, written
+ * * before versioning, still loads, with index.bin as its index.
+ * * Only the library is shared. The profile store and the relations file are small, so every process still
+ * * parses its own copy of them.
+ */
+namespace snapshot {
+
+/* * Encoded games and index files, independent of the globals they were built from. */
+struct SnapshotImages
+{
+        std::string games;
+        std::string index;
+};
+
+/**
+ * @brief Encodes steam_game_collection, steam_current_user_data and the current search indexes.
+ * * The save worker runs it under loader::LockData; the result can then be written from any thread.
+ */
+SnapshotImages BuildSnapshotImages();
+
+/**
+ * @brief Publishes prebuilt images: writes their versioned files unless already there, then points
+ * * games_path at them and deletes older versions.
+ * @return False if a file could not be written; games_path then still names the previous version.
+ */
+bool WriteSnapshotImages(const SnapshotImages&        images,
+                         const std::filesystem::path& games_path,
+                         const std::filesystem::path& index_path);
+
+/**
+ * @brief Atomically replaces path with any image built here.
+ * @return False if the file could not be written.
+ */
+bool WriteImage(const std::string& image, const std::filesystem::path& path);
+
+/**
+ * @brief Tells whether path already holds exactly image, by comparing the file's header with the image's.
+ * * The header carries the checksum of everything after it, so only the header is read; a save uses this to
+ * * skip rewriting a file whose content has not changed.
+ */
+bool FileHoldsImage(const std::filesystem::path& path, const std::string& image);
+
+/**
+ * @brief Tells whether games_path already publishes games_image, with an index built for it.
+ * * Any index built for the same games serves them equally well, so a save skips publishing when this holds.
+ */
+bool FileHoldsSnapshot(const std::filesystem::path& games_path,
+                       const std::filesystem::path& index_path,
+                       const std::string&           games_image);
+
+/**
+ * @brief Publishes the current search indexes, steam_game_collection and steam_current_user_data through
+ * * WriteSnapshotImages.
+ * @return False if a file could not be written.
+ */
+bool SaveGamesSnapshot(const std::filesystem::path& games_path, const std::filesystem::path& index_path);
+
+/**
+ * @brief Maps the games snapshot games_path publishes, checks it and loads it through catalog::LoadColumns.
+ * * The indexes are copied from its index file when it was written for this exact snapshot; otherwise they
+ * * are rebuilt and, if rewrite_stale_index is set, that index file is rewritten for the next start.
+ * @return False, leaving the library untouched, if the games file is missing, was written by another
+ * format version or byte order, is truncated, fails its checksum or points outside its name arena.
+ */
+bool LoadGamesSnapshot(const std::filesystem::path& games_path,
+                       const std::filesystem::path& index_path,
+                       bool                         rewrite_stale_index = true);
+
+/**
+ * @brief Maps the games snapshot games_path publishes and its index file and serves the library and every
+ * * index from them in place.
+ * * Nothing proportional to the library is copied: the collection columns, the prefix tree, the name and
+ * * AppID lookups and the infix and word posting lists all borrow the mappings, which stay open until the
+ * * next successful call. Any later change to the library copies what it touches first.
+ * @return False, leaving the library untouched, if either file is unreadable or the index file was not
+ * built for exactly this games file.
+ */
+bool ShareGamesSnapshot(const std::filesystem::path& games_path, const std::filesystem::path& index_path);
+
+/**
+ * @brief Tells whether games_path publishes another snapshot than the one ShareGamesSnapshot last looked at.
+ * * Reads only the pointer, or the header of a games.bin written before versioning. True before the first
+ * * ShareGamesSnapshot call.
+ */
+bool SharedSnapshotChanged(const std::filesystem::path& games_path);
+
+/* * Bytes of the files the library currently borrows from; 0 when it owns its data. */
+size_t SharedSnapshotBytes();
+
+/**
+ * @brief Encodes profile::steam_profile_store.
+ * * Like BuildSnapshotImages, run under loader::LockData so the result can be written from any thread.
+ */
+std::string BuildProfileStoreImage();
+
+/**
+ * @brief Atomically replaces path with an image from BuildProfileStoreImage.
+ * @return False if the file could not be written.
+ */
+bool WriteProfileStoreImage(const std::string& image, const std::filesystem::path& path);
+
+/**
+ * @brief Maps a profile store file, checks it and replaces profile::steam_profile_store with its contents.
+ * @return False, leaving the store untouched, if the file is missing, outdated, corrupt or has an app index
+ * or string outside its arrays.
+ */
+bool LoadProfileStore(const std::filesystem::path& path);
+} // namespace snapshot
+STEAM_END_NAMESPACE
+
+#endif
@@ -8,12 +8,21 @@
 #include <iostream>
 #include <regex>
 
+#include "api_client.hpp"
+#include "catalog.hpp"
 #include "data.hpp"
 #include "graph.hpp"
+#include "history.hpp"
 #include "handler.hpp"
+#include "infix.hpp"
 #include "loader.hpp"
+#include "mapped_file.hpp"
 #include "prefix.hpp"
 #include "process.hpp"
+#include "profile.hpp"
+#include "shared_array.hpp"
+#include "snapshot.hpp"
+#include "token.hpp"
 #include "undo.hpp"
 #include "utility.hpp"
 
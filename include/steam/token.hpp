@@ -0,0 +1,123 @@
+#ifndef STEAM_TOKEN_HPP
+#define STEAM_TOKEN_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "data.hpp"
+
+STEAM_BEGIN_NAMESPACE
+namespace token {
+
+/**
+ * @brief Splits lowercase text into words: maximal runs of ASCII letters, digits and non-ASCII bytes.
+ * @return Views into the given text, in order.
+ */
+std::vector<std::string_view> SplitWords(std::string_view lower_text);
+
+/**
+ * @brief Inverted index from lowercase name words to the games whose names contain them.
+ * * Posting lists are sorted by game index, so a multi-word query is an intersection of sorted lists.
+ * * Words are kept in a std::map so a query word can also match every indexed word it is a prefix of.
+ * * The words and lists can also be borrowed from a mapped index file and are copied only on the first change.
+ */
+struct TokenIndex
+{
+        std::map<std::string, std::vector<std::uint32_t>, std::less<>> postings_; /* * Word -> game indices */
+
+        /* * Used instead of postings_ while borrowed: word i (in ascending order) spans
+         * * borrowed_words_[borrowed_word_offsets_[i], borrowed_word_offsets_[i + 1]) and its list spans
+         * * borrowed_postings_[borrowed_offsets_[i], borrowed_offsets_[i + 1]). */
+        ArrayView<std::uint32_t> borrowed_word_offsets_;
+        std::string_view         borrowed_words_;
+        ArrayView<std::uint32_t> borrowed_offsets_;
+        ArrayView<std::uint32_t> borrowed_postings_;
+
+        /* * Clears all posting lists. */
+        void Clear()
+        {
+                postings_.clear();
+                borrowed_word_offsets_ = {};
+                borrowed_words_        = {};
+                borrowed_offsets_      = {};
+                borrowed_postings_     = {};
+        }
+
+        /**
+         * @brief Replaces the index with words and posting lists read in place, e.g. from a mapped index file.
+         * @param word_offsets One more entry than there are words, into words; the words must ascend.
+         * @param offsets As many entries as word_offsets, into postings.
+         */
+        void Borrow(ArrayView<std::uint32_t> word_offsets,
+                    std::string_view         words,
+                    ArrayView<std::uint32_t> offsets,
+                    ArrayView<std::uint32_t> postings);
+
+        bool IsBorrowed() const
+        {
+                return borrowed_offsets_.size > 0;
+        }
+
+        /* * Copies borrowed words and lists into postings_, so they can be changed; Insert and Erase call it first. */
+        void TakeOwnership();
+
+        /**
+         * @brief Adds a game's words to the index.
+         * @param lower_name The lowercase name of the game.
+         * @param game_index The index of the game in steam_game_collection.
+         * @return Posting list entries added.
+         */
+        size_t Insert(std::string_view lower_name, size_t game_index);
+
+        /**
+         * @brief Removes a game from the posting lists of its words; lists left empty are dropped.
+         * @param lower_name The lowercase name the game was inserted under.
+         * @param game_index The index the game was inserted with.
+         * @return Posting list entries removed.
+         */
+        size_t Erase(std::string_view lower_name, size_t game_index);
+
+        /**
+         * @brief Finds games containing every query word, in any order.
+         * * Each query word matches any name word starting with it ("souls dar" finds "Dark Souls").
+         * * Lists are intersected smallest first with a galloping search, so cost follows the rarest word.
+         * @param text The query; split into words like the names.
+         * @return Indices into steam_game_collection: games where more query words match whole words first,
+         * then games whose words appear in query order, then names with fewer words, then by lowercase name.
+         */
+        std::vector<size_t> SearchAllWords(const std::string& text) const;
+
+        size_t WordCount() const
+        {
+                return IsBorrowed() ? borrowed_offsets_.size - 1 : postings_.size();
+        }
+
+        /**
+         * @brief Approximate bytes held by the words, posting lists and tree nodes; borrowed ones count as 0.
+         */
+        size_t MemoryUsage() const;
+
+      private:
+        /* * Word i of a borrowed index. */
+        std::string_view BorrowedWord(size_t i) const
+        {
+                return borrowed_words_.substr(borrowed_word_offsets_[i],
+                                              borrowed_word_offsets_[i + 1] - borrowed_word_offsets_[i]);
+        }
+
+        /**
+         * @brief Collects the games containing a word that starts with the given query word.
+         * @param scratch Receives the merged list when more than one indexed word matches.
+         * @return The matching list (a stored posting list or scratch); empty if nothing matches.
+         */
+        ArrayView<std::uint32_t> MatchingGames(std::string_view query_word, std::vector<std::uint32_t>& scratch) const;
+};
+
+/* * Global word index over steam_game_collection's lowercase names. */
+extern TokenIndex steam_game_name_token_index;
+} // namespace token
+STEAM_END_NAMESPACE
+
+#endif
@@ -1,7 +1,11 @@
 #ifndef STEAM_UTILITY_HPP
 #define STEAM_UTILITY_HPP
+#include <cstddef>
+#include <cstdio>
 #include <filesystem>
+#include <functional>
 #include <string>
+#include <string_view>
 #include "base.hpp"
 
 STEAM_BEGIN_NAMESPACE
@@ -10,12 +14,108 @@ STEAM_BEGIN_NAMESPACE
  -------------------------------------------------------------------- */
 std::filesystem::path GetGamesDataPath();
 
+/** -----------------------------------------------------------------
+ * Helper function to get the full path to the binary games snapshot.
+ -------------------------------------------------------------------- */
+std::filesystem::path GetGamesSnapshotPath();
+
+/** -----------------------------------------------------------------
+ * Helper function to get the full path to the saved search indexes.
+ -------------------------------------------------------------------- */
+std::filesystem::path GetIndexSnapshotPath();
+
+/** -----------------------------------------------------------------
+ * Helper function to get the full path to the stored profiles.
+ -------------------------------------------------------------------- */
+std::filesystem::path GetProfileStorePath();
+
+/** -----------------------------------------------------------------
+ * Helper function to get the full path to the playtime time series.
+ -------------------------------------------------------------------- */
+std::filesystem::path GetPlaytimeHistoryPath();
+
+/** -----------------------------------------------------------------
+ * Helper function to get the full path to the cached API key checks.
+ -------------------------------------------------------------------- */
+std::filesystem::path GetApiKeyCachePath();
+
+/** -----------------------------------------------------------------
+ * @brief Opens a file with std::fopen modes, taking the path as UTF-16 on Windows.
+ * @return nullptr on failure.
+ -------------------------------------------------------------------- */
+std::FILE* OpenFile(const std::filesystem::path& path, const char* mode);
+
+/** -----------------------------------------------------------------
+ * @brief Flushes a stream's buffers and asks the OS to put the file's data on disk (fsync).
+ * @return False if either step failed.
+ -------------------------------------------------------------------- */
+bool FlushFileToDisk(std::FILE* file);
+
+/** -----------------------------------------------------------------
+ * @brief Replaces a file atomically: writes a sibling temp file, flushes it to disk, then renames it
+ * over the target, so a crash leaves either the old file or the complete new one.
+ * The temp file is named after the target, the process ID and a per-process counter, so concurrent
+ * writers (threads or processes) of one target each write their own.
+ * @param path The file to replace.
+ * @param write Streams the new content into the open temp file; returns false to abandon the write.
+ * @return False if any step failed; the target is untouched then.
+ -------------------------------------------------------------------- */
+bool WriteFileAtomically(const std::filesystem::path& path, const std::function<bool(std::FILE*)>& write);
+
+/** -----------------------------------------------------------------
+ * @brief Percent-encodes text for use as one query parameter value.
+ * * Every byte but ASCII letters, digits and "-._~" becomes %XX, so '&', '#', spaces and UTF-8 in a
+ * * user-supplied name cannot change the request.
+ -------------------------------------------------------------------- */
+std::string EncodeUrlComponent(std::string_view text);
+
 /** -----------------------------------------------------------------
  * @brief Converts a string to lowercase.
+ * * ASCII runs are lowered 16 or 32 bytes at a time (SSE2, or AVX2 when the CPU has it);
+ * * UTF-8 sequences are case-folded per code point for Latin, Greek, Cyrillic and fullwidth
+ * * letters. Malformed UTF-8 is copied unchanged.
  * @param input_string The string to convert.
  * @return The lowercase version of the input string.
  -------------------------------------------------------------------- */
-std::string ToLower(const std::string& input_string);
+std::string ToLower(std::string_view input_string);
+
+/** -----------------------------------------------------------------
+ * @brief Compares two strings as if both were passed through ToLower, without allocating.
+ * @return Negative, zero or positive, like std::string_view::compare on the lowered strings' code points.
+ -------------------------------------------------------------------- */
+int CompareIgnoreCase(std::string_view a, std::string_view b);
+
+/** -----------------------------------------------------------------
+ * @brief Hashes a string as if it were passed through ToLower, without allocating.
+ * * Strings that CompareIgnoreCase reports equal hash equally.
+ -------------------------------------------------------------------- */
+size_t HashIgnoreCase(std::string_view input_string);
+
+/** -----------------------------------------------------------------
+ * @brief True for bytes that can be part of a word in a game name.
+ * * ASCII letters of either case, digits, and every byte of a UTF-8 sequence; everything else separates words.
+ -------------------------------------------------------------------- */
+inline bool IsWordCharacter(char ch)
+{
+        const auto byte = static_cast<unsigned char>(ch);
+        return byte >= 0x80 || (byte >= '0' && byte <= '9') || ((byte | 0x20) >= 'a' && (byte | 0x20) <= 'z');
+}
+
+/* * Hash and equality for case-insensitive std::unordered_map keys. */
+struct IgnoreCaseHash
+{
+        size_t operator()(std::string_view key) const
+        {
+                return HashIgnoreCase(key);
+        }
+};
+struct IgnoreCaseEqual
+{
+        bool operator()(std::string_view a, std::string_view b) const
+        {
+                return CompareIgnoreCase(a, b) == 0;
+        }
+};
 STEAM_END_NAMESPACE
 
 #endif
\ No newline at end of file
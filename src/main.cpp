@@ -4,8 +4,7 @@ int main()
 {
         using namespace fmt;
         using namespace steam;
-        loader::LoadGamesDataFromJson();
-        graph::LoadRelations();
+        loader::StartLoadingData(); // Returns at once; commands that need the data wait for it
 
         print(fg(color::gold) | emphasis::bold, "v1.1 - Type 'help' for commands", '\n');
         print(fg(color::gold), "\n:::::::::::::::::::::::\n");
@@ -18,12 +17,13 @@ int main()
 
                 /**Input**
                  ****/
+                loader::ReportSaveFailures(); // Collected by the save worker, printed here between commands
                 print(fg(color::light_cyan) | emphasis::bold, "> ");
                 if (!std::getline(std::cin, user_input_line)) {
                         if (std::cin.eof()) {
-                                print(fg(color::yellow), "{}EOF detected. Exiting...{}", '\n');
+                                print(fg(color::yellow), "\nEOF detected. Exiting...\n");
                         } else {
-                                print(fg(color::indian_red), "{}Input error. Exiting...{}", '\n');
+                                print(fg(color::indian_red), "\nInput error. Exiting...\n");
                         }
                         break;
                 }
@@ -59,6 +59,10 @@ int main()
 
         /**End program**
          ****/
+        loader::WaitUntilDataLoaded(); // A load still running must not outlive the globals it fills
+        loader::WaitUntilApiKeyChecked();
+        loader::FlushPendingSaves(); // Changes still inside the save debounce are written now
+        loader::ReportSaveFailures();
         return 0;
 }
 
@@ -0,0 +1,237 @@
+#include "steam/api_client.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <vector>
+
+STEAM_BEGIN_NAMESPACE
+namespace api_client {
+
+/* * Sockets opened by any pooled client; counted from the clients' socket option callbacks. */
+static std::atomic<size_t> connections_opened { 0 };
+
+struct PooledClient
+{
+        std::unique_ptr<httplib::Client>      client;
+        std::chrono::steady_clock::time_point last_used;
+};
+
+class ClientPool
+{
+      public:
+        void Configure(size_t pool_size, std::chrono::seconds idle_timeout)
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pool_size_    = pool_size;
+                idle_timeout_ = idle_timeout;
+        }
+
+        /* * Takes an idle client, opens a new one if the pool has room, or waits for one to be returned. */
+        std::unique_ptr<PooledClient> Acquire()
+        {
+                std::unique_lock<std::mutex> lock(mutex_);
+                CloseExpired();
+                available_.wait(lock, [this] {
+                        return !idle_.empty() || leased_ + idle_.size() < pool_size_;
+                });
+                ++leased_;
+                ++requests_;
+                if (!idle_.empty()) {
+                        std::unique_ptr<PooledClient> pooled = std::move(idle_.back());
+                        idle_.pop_back();
+                        return pooled;
+                }
+                lock.unlock();
+                auto pooled    = std::make_unique<PooledClient>();
+                pooled->client = std::make_unique<httplib::Client>(kSteamApiHost);
+                pooled->client->set_keep_alive(true);
+                pooled->client->set_connection_timeout(kConnectTimeoutSeconds, 0);
+                pooled->client->set_socket_options([](httplib::socket_t) {
+                        ++connections_opened;
+                });
+                return pooled;
+        }
+
+        void Release(std::unique_ptr<PooledClient> pooled)
+        {
+                pooled->last_used = std::chrono::steady_clock::now();
+                {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        --leased_;
+                        /* * Most recently used last, so Acquire takes the connection least likely to have expired. */
+                        idle_.push_back(std::move(pooled));
+                        CloseExpired();
+                }
+                available_.notify_one();
+        }
+
+        size_t Size()
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return pool_size_;
+        }
+
+        PoolStats Stats()
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                PoolStats stats;
+                stats.requests           = requests_;
+                stats.connections_opened = connections_opened;
+                stats.idle_closed        = idle_closed_;
+                stats.open               = leased_ + idle_.size();
+                return stats;
+        }
+
+      private:
+        /* * Drops clients idle past the timeout, oldest first; mutex_ must be held. */
+        void CloseExpired()
+        {
+                const auto expired_before = std::chrono::steady_clock::now() - idle_timeout_;
+                size_t     expired        = 0;
+                while (expired < idle_.size() && idle_[expired]->last_used < expired_before) {
+                        idle_[expired]->client->stop();
+                        ++expired;
+                }
+                idle_.erase(idle_.begin(), idle_.begin() + expired);
+                idle_closed_ += expired;
+        }
+
+        std::mutex                                 mutex_;
+        std::condition_variable                    available_;
+        std::vector<std::unique_ptr<PooledClient>> idle_; /* * Oldest first */
+        size_t                                     leased_       = 0;
+        size_t                                     pool_size_    = kDefaultPoolSize;
+        std::chrono::seconds                       idle_timeout_ = std::chrono::seconds(kDefaultIdleSeconds);
+        size_t                                     requests_     = 0;
+        size_t                                     idle_closed_  = 0;
+};
+
+static ClientPool client_pool;
+
+void Configure(size_t pool_size, std::chrono::seconds idle_timeout)
+{
+        client_pool.Configure(pool_size < 1 ? 1 : pool_size, idle_timeout);
+}
+
+/**
+ * @brief Bounded byte pipe from a download thread to a reading thread, read through std::istream.
+ * * Push blocks while kStreamBufferBytes are waiting; underflow blocks until a chunk arrives or the writer
+ * * closes the pipe. After Discard, pushed bytes are dropped so the download can finish without a reader.
+ */
+class BodyPipe : public std::streambuf
+{
+      public:
+        bool Push(const char* data, size_t size)
+        {
+                std::unique_lock<std::mutex> lock(mutex_);
+                space_.wait(lock, [this, size] {
+                        return discarded_ || queued_bytes_ == 0 || queued_bytes_ + size <= kStreamBufferBytes;
+                });
+                if (!discarded_) {
+                        chunks_.emplace_back(data, size);
+                        queued_bytes_ += size;
+                        ready_.notify_one();
+                }
+                return true;
+        }
+
+        void Close()
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closed_ = true;
+                ready_.notify_all();
+        }
+
+        void Discard()
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                discarded_ = true;
+                chunks_.clear();
+                space_.notify_all();
+        }
+
+      protected:
+        int_type underflow() override
+        {
+                if (gptr() < egptr()) {
+                        return traits_type::to_int_type(*gptr());
+                }
+                std::unique_lock<std::mutex> lock(mutex_);
+                queued_bytes_ -= reading_.size();
+                reading_.clear();
+                space_.notify_all();
+                ready_.wait(lock, [this] {
+                        return !chunks_.empty() || closed_;
+                });
+                if (chunks_.empty()) {
+                        return traits_type::eof();
+                }
+                reading_ = std::move(chunks_.front());
+                chunks_.pop_front();
+                setg(&reading_[0], &reading_[0], &reading_[0] + reading_.size());
+                return traits_type::to_int_type(*gptr());
+        }
+
+      private:
+        std::mutex              mutex_;
+        std::condition_variable ready_;
+        std::condition_variable space_;
+        std::deque<std::string> chunks_;
+        std::string             reading_;          /* * The chunk the get area points into */
+        size_t                  queued_bytes_ = 0; /* * Including reading_ */
+        bool                    closed_       = false;
+        bool                    discarded_    = false;
+};
+
+httplib::Result Get(const std::string& path, int read_timeout_seconds)
+{
+        std::unique_ptr<PooledClient> pooled = client_pool.Acquire();
+        pooled->client->set_read_timeout(read_timeout_seconds, 0);
+        httplib::Result result = pooled->client->Get(path);
+        client_pool.Release(std::move(pooled));
+        return result;
+}
+
+httplib::Result GetStreamed(const std::string&                       path,
+                            int                                      read_timeout_seconds,
+                            const std::function<void(std::istream&)>& read_body)
+{
+        BodyPipe pipe;
+        auto     download = std::async(std::launch::async, [&pipe, &path, read_timeout_seconds] {
+                std::unique_ptr<PooledClient> pooled = client_pool.Acquire();
+                pooled->client->set_read_timeout(read_timeout_seconds, 0);
+                httplib::Result result = pooled->client->Get(path, [&pipe](const char* data, size_t size) {
+                        return pipe.Push(data, size);
+                });
+                client_pool.Release(std::move(pooled));
+                pipe.Close();
+                return result;
+        });
+        std::istream body(&pipe);
+        try {
+                read_body(body);
+        } catch (...) {
+                pipe.Discard();
+                download.wait();
+                throw;
+        }
+        pipe.Discard();
+        return download.get();
+}
+
+PoolStats GetPoolStats()
+{
+        return client_pool.Stats();
+}
+
+size_t PoolSize()
+{
+        return client_pool.Size();
+}
+} // namespace api_client
+STEAM_END_NAMESPACE
@@ -1,10 +1,18 @@
 #include "steam/api_key.hpp"
+#include "steam/api_client.hpp"
 #include "steam/data.hpp"
 #include "steam/utility.hpp"
 
+#include <algorithm> // For std::remove_if
+#include <cstdint>
+#include <cstdio> // For std::sscanf
 #include <cstdlib>
+#include <ctime> // For std::time
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 using namespace fmt;
 using json = nlohmann::json;
@@ -12,17 +20,110 @@ STEAM_BEGIN_NAMESPACE
 
 namespace api_key {
 
+/* * Checks remembered per file; the oldest beyond this many are dropped. */
+static constexpr size_t kMaxCachedChecks = 8;
+
+/* * One line of the cache file: "<key hash> <1 valid | 0 invalid> <Unix time of the check>". */
+struct CachedCheck
+{
+        std::uint64_t key_hash;
+        bool          valid;
+        std::int64_t  checked_at;
+};
+
+/* * Guards the cache file; the startup check runs on a background thread. */
+static std::mutex cache_mutex;
+
+/* * FNV-1a of the key. Only this hash is written to the cache, never the key itself. */
+static std::uint64_t HashKey(const std::string& key)
+{
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        for (unsigned char ch : key) {
+                hash = (hash ^ ch) * 0x100000001B3ull;
+        }
+        return hash;
+}
+
+static std::vector<CachedCheck> ReadCachedChecks()
+{
+        std::vector<CachedCheck> checks;
+        std::ifstream            ifs(GetApiKeyCachePath());
+        std::string              line;
+        while (std::getline(ifs, line)) {
+                unsigned long long key_hash   = 0;
+                int                valid      = 0;
+                long long          checked_at = 0;
+                if (std::sscanf(line.c_str(), "%llx %d %lld", &key_hash, &valid, &checked_at) == 3) {
+                        checks.push_back({ key_hash, valid != 0, checked_at });
+                }
+        }
+        return checks;
+}
+
+/* * The cached verdict on a key if it was checked less than kApiKeyCacheHours ago. */
+static std::optional<bool> CachedVerdict(const std::string& key)
+{
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        const std::uint64_t         key_hash = HashKey(key);
+        const std::int64_t          now      = std::time(nullptr);
+        for (const CachedCheck& check : ReadCachedChecks()) {
+                if (check.key_hash == key_hash && check.checked_at <= now
+                    && now - check.checked_at < std::int64_t(kApiKeyCacheHours) * 3600) {
+                        return check.valid;
+                }
+        }
+        return std::nullopt;
+}
+
+/* * Stores the verdict on a key, replacing any older one for the same key. */
+static void RememberVerdict(const std::string& key, bool valid)
+{
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        const std::uint64_t         key_hash = HashKey(key);
+        std::vector<CachedCheck>    checks   = ReadCachedChecks();
+        checks.erase(
+            std::remove_if(
+                checks.begin(),
+                checks.end(),
+                [key_hash](const CachedCheck& check) {
+                        return check.key_hash == key_hash;
+                }),
+            checks.end());
+        checks.push_back({ key_hash, valid, static_cast<std::int64_t>(std::time(nullptr)) });
+        if (checks.size() > kMaxCachedChecks) {
+                checks.erase(checks.begin(), checks.end() - kMaxCachedChecks);
+        }
+        WriteFileAtomically(GetApiKeyCachePath(), [&checks](std::FILE* file) {
+                for (const CachedCheck& check : checks) {
+                        fmt::print(file, "{:016x} {} {}\n", check.key_hash, check.valid ? 1 : 0, check.checked_at);
+                }
+                return std::ferror(file) == 0;
+        });
+}
+
+void RecordRejectedKey(const std::string& key)
+{
+        if (!key.empty()) {
+                RememberVerdict(key, false);
+        }
+}
+
 bool isSteamAPIKeyValid(const std::string& key)
 {
         if (key.empty()) {
                 return false;
         }
-        httplib::Client client("api.steampowered.com");
-        client.set_connection_timeout(5, 0);
-        client.set_read_timeout(10, 0);
-
+        if (const std::optional<bool> cached = CachedVerdict(key)) {
+                if (!*cached) {
+                        print(
+                            fg(color::indian_red),
+                            "Error: Steam API key is invalid (checked within the last {} hours).\n",
+                            kApiKeyCacheHours);
+                }
+                return *cached;
+        }
         std::string endpoint = format("/ISteamWebAPIUtil/GetSupportedAPIList/v1/?key={}", key);
-        auto        res      = client.Get(endpoint.c_str());
+        auto        res      = api_client::Get(endpoint, 10);
         if (!res) {
                 print(fg(color::indian_red), "Error: Could not connect to Steam API to validate key.\n");
                 return false;
@@ -30,6 +131,7 @@ bool isSteamAPIKeyValid(const std::string& key)
         if (res->status == 200) {
                 try {
                         auto json_body = json::parse(res->body);
+                        RememberVerdict(key, true);
                         if (json_body.contains("apilist") && json_body["apilist"].contains("interfaces")) {
 
                                 return true;
@@ -45,6 +147,7 @@ bool isSteamAPIKeyValid(const std::string& key)
                 }
         } else if (res->status == 403) {
                 print(fg(color::indian_red), "Error: Steam API key is invalid (403 Forbidden).\n");
+                RememberVerdict(key, false);
                 return false;
         } else {
                 print(fg(color::indian_red), "Error: Steam API returned status {} for key validation.\n", res->status);
@@ -52,14 +155,16 @@ bool isSteamAPIKeyValid(const std::string& key)
         }
 }
 
-bool LoadApiKeyFromEnv()
+std::string ReadEnvApiKey()
 {
-
-        dotenv::init();
         const char* env_api_key_cstr = std::getenv("STEAM_API_KEY");
+        return env_api_key_cstr != nullptr ? env_api_key_cstr : "";
+}
 
-        if (env_api_key_cstr != nullptr && std::string(env_api_key_cstr).length() > 0) {
-                steam_api_key = env_api_key_cstr;
+bool LoadApiKeyFromEnv(const std::string& env_api_key)
+{
+        if (!env_api_key.empty()) {
+                steam_api_key = env_api_key;
                 if (isSteamAPIKeyValid(steam_api_key)) {
                         return true;
                 } else {
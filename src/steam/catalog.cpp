@@ -0,0 +1,336 @@
+#include "steam/catalog.hpp"
+
+#include <algorithm> // For std::lower_bound, std::max
+#include <future>    // For std::async in BuildIndexes
+#include <thread>    // For std::thread::hardware_concurrency
+
+STEAM_BEGIN_NAMESPACE
+namespace catalog {
+
+/* * Index entries changed by game-at-a-time updates since the start; bulk loads are not counted. */
+static size_t index_entries_touched = 0;
+
+/* * Adds the game stored at an index of steam_game_collection to every index. */
+static void IndexGame(size_t index)
+{
+        const std::string name(steam_game_collection.Name(index));
+        const std::string lower_name(steam_game_collection.LowerName(index));
+
+        prefix::steam_game_name_prefix_tree.Insert(name, index);
+        /* * Duplicate names resolve to the highest index, matching a load that assigns in order. */
+        auto [name_it, inserted] = prefix::steam_game_name_to_index_map.emplace(lower_name, index);
+        if (!inserted && name_it->second < index) {
+                name_it->second = index;
+        }
+        prefix::steam_game_app_id_to_index_map.emplace(steam_game_collection.AppId(index), index);
+        index_entries_touched += 3 + infix::steam_game_name_infix_index.Insert(lower_name, index)
+                                 + token::steam_game_name_token_index.Insert(lower_name, index);
+}
+
+/* * Removes the game stored at an index of steam_game_collection from every index; the collection is untouched. */
+static void UnindexGame(size_t index)
+{
+        const std::string name(steam_game_collection.Name(index));
+        const std::string lower_name(steam_game_collection.LowerName(index));
+
+        prefix::steam_game_name_prefix_tree.Erase(name, index);
+        index_entries_touched += 1 + infix::steam_game_name_infix_index.Erase(lower_name, index)
+                                 + token::steam_game_name_token_index.Erase(lower_name, index);
+
+        auto name_it = prefix::steam_game_name_to_index_map.find(lower_name);
+        if (name_it != prefix::steam_game_name_to_index_map.end() && name_it->second == index) {
+                prefix::steam_game_name_to_index_map.erase(name_it);
+                ++index_entries_touched;
+                /* * Another game with the same name takes over the entry. */
+                for (size_t other : prefix::steam_game_name_prefix_tree.SearchByPrefix(lower_name)) {
+                        if (steam_game_collection.LowerName(other) == lower_name) {
+                                prefix::steam_game_name_to_index_map[lower_name] = other;
+                        }
+                }
+        }
+
+        auto app_id_it = prefix::steam_game_app_id_to_index_map.find(steam_game_collection.AppId(index));
+        if (app_id_it != prefix::steam_game_app_id_to_index_map.end() && app_id_it->second == index) {
+                prefix::steam_game_app_id_to_index_map.erase(app_id_it);
+                ++index_entries_touched;
+        }
+}
+
+/* * Used instead of the name and AppID maps while borrowed; see BorrowLookups. */
+static ArrayView<std::uint32_t> borrowed_by_name;
+static ArrayView<std::uint32_t> borrowed_by_app_id;
+
+/* * Empties every index but leaves the collection alone. */
+static void ClearIndexes()
+{
+        borrowed_by_name   = {};
+        borrowed_by_app_id = {};
+        prefix::steam_game_name_prefix_tree.Clear();
+        prefix::steam_game_name_to_index_map.clear();
+        prefix::steam_game_app_id_to_index_map.clear();
+        infix::steam_game_name_infix_index.Clear();
+        token::steam_game_name_token_index.Clear();
+}
+
+/**
+ * @brief Fills the emptied indexes from the whole collection.
+ * * Large libraries build each index on its own thread, and the prefix tree across several more.
+ */
+static void BuildIndexes()
+{
+        const size_t   game_count = steam_game_collection.size();
+        const unsigned threads    = game_count >= kParallelBuildMinGames ? std::thread::hardware_concurrency() : 1;
+        Reserve(game_count);
+        if (threads <= 1) {
+                for (size_t index = 0; index < game_count; ++index) {
+                        IndexGame(index);
+                }
+                return;
+        }
+
+        auto maps = std::async(std::launch::async, [game_count] {
+                /* * Ascending order, so a duplicate name ends on its highest index as in IndexGame. */
+                auto& name_map = prefix::steam_game_name_to_index_map;
+                for (size_t index = 0; index < game_count; ++index) {
+                        name_map[std::string(steam_game_collection.LowerName(index))] = index;
+                }
+                for (size_t index = 0; index < game_count; ++index) {
+                        prefix::steam_game_app_id_to_index_map.emplace(steam_game_collection.AppId(index), index);
+                }
+        });
+        auto infix = std::async(std::launch::async, [game_count] {
+                for (size_t index = 0; index < game_count; ++index) {
+                        infix::steam_game_name_infix_index.Insert(steam_game_collection.LowerName(index), index);
+                }
+        });
+        auto token = std::async(std::launch::async, [game_count] {
+                for (size_t index = 0; index < game_count; ++index) {
+                        token::steam_game_name_token_index.Insert(steam_game_collection.LowerName(index), index);
+                }
+        });
+        prefix::steam_game_name_prefix_tree.InsertAll(game_count, threads);
+        maps.get();
+        infix.get();
+        token.get();
+}
+
+void BorrowColumns(const data::GameColumns& columns)
+{
+        Clear();
+        steam_game_collection.BorrowColumns(columns);
+}
+
+void BorrowLookups(ArrayView<std::uint32_t> by_name, ArrayView<std::uint32_t> by_app_id)
+{
+        prefix::steam_game_name_to_index_map.clear();
+        prefix::steam_game_app_id_to_index_map.clear();
+        borrowed_by_name   = by_name;
+        borrowed_by_app_id = by_app_id;
+}
+
+void OwnIndexes()
+{
+        infix::steam_game_name_infix_index.TakeOwnership();
+        token::steam_game_name_token_index.TakeOwnership();
+        if (borrowed_by_name.data == nullptr) {
+                return;
+        }
+        for (std::uint32_t index : borrowed_by_name) {
+                prefix::steam_game_name_to_index_map.emplace(steam_game_collection.LowerName(index), index);
+        }
+        for (std::uint32_t index : borrowed_by_app_id) {
+                prefix::steam_game_app_id_to_index_map.emplace(steam_game_collection.AppId(index), index);
+        }
+        borrowed_by_name   = {};
+        borrowed_by_app_id = {};
+}
+
+size_t FindGameByAppId(int app_id)
+{
+        const size_t game_count = steam_game_collection.size();
+        if (borrowed_by_app_id.data != nullptr) {
+                const auto by_app_id = [](std::uint32_t index, int key) {
+                        return steam_game_collection.AppId(index) < key;
+                };
+                const auto found = std::lower_bound(
+                    borrowed_by_app_id.begin(), borrowed_by_app_id.end(), app_id, by_app_id);
+                if (found == borrowed_by_app_id.end() || steam_game_collection.AppId(*found) != app_id) {
+                        return game_count;
+                }
+                return *found;
+        }
+        auto map_it = prefix::steam_game_app_id_to_index_map.find(app_id);
+        if (map_it == prefix::steam_game_app_id_to_index_map.end() || map_it->second >= game_count) {
+                return game_count;
+        }
+        return map_it->second;
+}
+
+size_t FindGameByName(std::string_view name)
+{
+        const size_t game_count = steam_game_collection.size();
+        if (borrowed_by_name.data != nullptr) {
+                const std::string lower_name = ToLower(name);
+                const auto        by_name    = [](std::uint32_t index, std::string_view key) {
+                        return steam_game_collection.LowerName(index) < key;
+                };
+                const auto found = std::lower_bound(
+                    borrowed_by_name.begin(), borrowed_by_name.end(), std::string_view(lower_name), by_name);
+                if (found == borrowed_by_name.end() || steam_game_collection.LowerName(*found) != lower_name) {
+                        return game_count;
+                }
+                return *found;
+        }
+        auto map_it = prefix::steam_game_name_to_index_map.find(std::string(name));
+        if (map_it == prefix::steam_game_name_to_index_map.end() || map_it->second >= game_count) {
+                return game_count;
+        }
+        return map_it->second;
+}
+
+void Clear()
+{
+        steam_game_collection.clear();
+        ClearIndexes();
+}
+
+void Reserve(size_t game_count)
+{
+        steam_game_collection.reserve(game_count);
+        prefix::steam_game_name_to_index_map.reserve(game_count);
+        prefix::steam_game_app_id_to_index_map.reserve(game_count);
+}
+
+bool LoadColumns(const data::GameColumns& columns, const std::function<bool()>& restore_indexes)
+{
+        Clear();
+        steam_game_collection.AssignColumns(columns);
+        if (restore_indexes && restore_indexes()) {
+                return true;
+        }
+        ClearIndexes();
+        BuildIndexes();
+        return false;
+}
+
+size_t AddGame(const data::GameData& game)
+{
+        OwnIndexes();
+        steam_game_collection.push_back(game);
+        const size_t index = steam_game_collection.size() - 1;
+        IndexGame(index);
+        return index;
+}
+
+bool RemoveGame(int app_id)
+{
+        OwnIndexes();
+        const size_t index = FindGameByAppId(app_id);
+        if (index == steam_game_collection.size()) {
+                return false;
+        }
+        const size_t last = steam_game_collection.size() - 1;
+
+        UnindexGame(index);
+        if (index != last) {
+                const data::GameData moved = { std::string(steam_game_collection.Name(last)),
+                                               steam_game_collection.AppId(last),
+                                               steam_game_collection.Playtime(last) };
+                UnindexGame(last);
+                steam_game_collection.Assign(index, moved);
+                steam_game_collection.pop_back();
+                IndexGame(index);
+        } else {
+                steam_game_collection.pop_back();
+        }
+        return true;
+}
+
+bool RenameGame(int app_id, const std::string& new_name)
+{
+        OwnIndexes();
+        const size_t index = FindGameByAppId(app_id);
+        if (index == steam_game_collection.size()) {
+                return false;
+        }
+        UnindexGame(index);
+        steam_game_collection.Assign(index, { new_name, app_id, steam_game_collection.Playtime(index) });
+        IndexGame(index);
+        return true;
+}
+
+bool SetPlaytime(int app_id, int playtime_forever)
+{
+        OwnIndexes();
+        const size_t index = FindGameByAppId(app_id);
+        if (index == steam_game_collection.size()) {
+                return false;
+        }
+        if (steam_game_collection.Playtime(index) == playtime_forever) {
+                return true;
+        }
+        /* * Only the prefix tree's top caches rank by playtime; they are re-ranked in place along the name. */
+        const int previous_playtime = steam_game_collection.Playtime(index);
+        steam_game_collection.SetPlaytime(index, playtime_forever);
+        prefix::steam_game_name_prefix_tree.UpdatePlaytime(
+            std::string(steam_game_collection.Name(index)), index, previous_playtime);
+        ++index_entries_touched;
+        return true;
+}
+
+LibraryDiff ApplyFetchedGames(const data::GameCollection& fetched)
+{
+        LibraryDiff       diff;
+        std::vector<bool> still_owned(steam_game_collection.size(), false);
+        for (size_t index = 0; index < fetched.size(); ++index) {
+                const int    app_id  = fetched.AppId(index);
+                const size_t current = FindGameByAppId(app_id);
+                if (current == steam_game_collection.size()) {
+                        diff.added.push_back({ std::string(fetched.Name(index)), app_id, fetched.Playtime(index) });
+                        continue;
+                }
+                still_owned[current] = true;
+                if (steam_game_collection.Name(current) != fetched.Name(index)) {
+                        diff.renamed.push_back({ app_id,
+                                                 std::string(steam_game_collection.Name(current)),
+                                                 std::string(fetched.Name(index)) });
+                }
+                if (steam_game_collection.Playtime(current) != fetched.Playtime(index)) {
+                        diff.playtime_changes.push_back({ app_id,
+                                                          std::string(fetched.Name(index)),
+                                                          steam_game_collection.Playtime(current),
+                                                          fetched.Playtime(index) });
+                }
+        }
+        for (size_t current = 0; current < still_owned.size(); ++current) {
+                if (!still_owned[current]) {
+                        diff.removed.push_back({ std::string(steam_game_collection.Name(current)),
+                                                 steam_game_collection.AppId(current),
+                                                 steam_game_collection.Playtime(current) });
+                }
+        }
+
+        const size_t library_size = std::max(fetched.size(), steam_game_collection.size());
+        if (diff.ChangeCount() * kDeltaRebuildDivisor > library_size) {
+                LoadColumns(fetched.Columns());
+                diff.rebuilt = true;
+                return diff;
+        }
+        const size_t touched_before = index_entries_touched;
+        for (const data::GameData& game : diff.removed) {
+                RemoveGame(game.app_id);
+        }
+        for (const NameChange& change : diff.renamed) {
+                RenameGame(change.app_id, change.new_name);
+        }
+        for (const PlaytimeChange& change : diff.playtime_changes) {
+                SetPlaytime(change.app_id, change.new_playtime);
+        }
+        for (const data::GameData& game : diff.added) {
+                AddGame(game);
+        }
+        diff.index_entries = index_entries_touched - touched_before;
+        return diff;
+}
+} // namespace catalog
+STEAM_END_NAMESPACE
@@ -0,0 +1,205 @@
+#include "steam/data.hpp"
+
+#include "steam/utility.hpp" // For ToLower
+
+#include <algorithm> // For std::stable_sort
+#include <numeric>   // For std::iota
+#include <utility>   // For std::move
+
+STEAM_BEGIN_NAMESPACE
+namespace data {
+
+void GameCollection::clear()
+{
+        app_ids_.clear();
+        playtimes_.clear();
+        name_offsets_.clear();
+        name_lengths_.clear();
+        lower_name_offsets_.clear();
+        lower_name_lengths_.clear();
+        name_arena_.clear();
+        garbage_name_bytes_ = 0;
+        ++names_version_;
+}
+
+void GameCollection::reserve(size_t game_count, size_t name_bytes)
+{
+        app_ids_.reserve(game_count);
+        playtimes_.reserve(game_count);
+        name_offsets_.reserve(game_count);
+        name_lengths_.reserve(game_count);
+        lower_name_offsets_.reserve(game_count);
+        lower_name_lengths_.reserve(game_count);
+        /* * Worst case every name needs a separate lowercase copy. */
+        name_arena_.reserve(name_bytes * 2);
+}
+
+void GameCollection::AppendName(size_t index, const std::string& name)
+{
+        const std::string lower_name  = ToLower(name);
+        const auto        name_offset = static_cast<std::uint32_t>(name_arena_.size());
+        name_arena_.append(name.data(), name.size());
+
+        /* * Names that are already lowercase share their bytes with the lowercase key. */
+        std::uint32_t lower_offset = name_offset;
+        if (lower_name != name) {
+                lower_offset = static_cast<std::uint32_t>(name_arena_.size());
+                name_arena_.append(lower_name.data(), lower_name.size());
+        }
+
+        name_offsets_[index]       = name_offset;
+        name_lengths_[index]       = static_cast<std::uint32_t>(name.size());
+        lower_name_offsets_[index] = lower_offset;
+        lower_name_lengths_[index] = static_cast<std::uint32_t>(lower_name.size());
+}
+
+void GameCollection::push_back(const GameData& game)
+{
+        app_ids_.push_back(game.app_id);
+        playtimes_.push_back(game.playtime_forever);
+        name_offsets_.emplace_back();
+        name_lengths_.emplace_back();
+        lower_name_offsets_.emplace_back();
+        lower_name_lengths_.emplace_back();
+        AppendName(app_ids_.size() - 1, game.name);
+        ++names_version_;
+}
+
+void GameCollection::pop_back()
+{
+        const size_t last = app_ids_.size() - 1;
+        garbage_name_bytes_ += NameBytes(last);
+        app_ids_.pop_back();
+        playtimes_.pop_back();
+        name_offsets_.pop_back();
+        name_lengths_.pop_back();
+        lower_name_offsets_.pop_back();
+        lower_name_lengths_.pop_back();
+        CompactNamesIfSparse();
+        ++names_version_;
+}
+
+void GameCollection::Assign(size_t index, const GameData& game)
+{
+        garbage_name_bytes_ += NameBytes(index);
+        app_ids_[index]   = game.app_id;
+        playtimes_[index] = game.playtime_forever;
+        AppendName(index, game.name);
+        CompactNamesIfSparse();
+        ++names_version_;
+}
+
+void GameCollection::AssignColumns(const GameColumns& columns)
+{
+        const size_t count = columns.count;
+        app_ids_.assign(columns.app_ids, columns.app_ids + count);
+        playtimes_.assign(columns.playtimes, columns.playtimes + count);
+        name_offsets_.assign(columns.name_offsets, columns.name_offsets + count);
+        name_lengths_.assign(columns.name_lengths, columns.name_lengths + count);
+        lower_name_offsets_.assign(columns.lower_name_offsets, columns.lower_name_offsets + count);
+        lower_name_lengths_.assign(columns.lower_name_lengths, columns.lower_name_lengths + count);
+        name_arena_.assign(columns.name_arena.data(), columns.name_arena.data() + columns.name_arena.size());
+        garbage_name_bytes_ = 0;
+        ++names_version_;
+}
+
+void GameCollection::BorrowColumns(const GameColumns& columns)
+{
+        const size_t count = columns.count;
+        app_ids_.Borrow(columns.app_ids, count);
+        playtimes_.Borrow(columns.playtimes, count);
+        name_offsets_.Borrow(columns.name_offsets, count);
+        name_lengths_.Borrow(columns.name_lengths, count);
+        lower_name_offsets_.Borrow(columns.lower_name_offsets, count);
+        lower_name_lengths_.Borrow(columns.lower_name_lengths, count);
+        name_arena_.Borrow(columns.name_arena.data(), columns.name_arena.size());
+        garbage_name_bytes_ = 0;
+        ++names_version_;
+}
+
+GameColumns GameCollection::Columns() const
+{
+        return { size(),
+                 app_ids_.data(),
+                 playtimes_.data(),
+                 name_offsets_.data(),
+                 name_lengths_.data(),
+                 lower_name_offsets_.data(),
+                 lower_name_lengths_.data(),
+                 { name_arena_.data(), name_arena_.size() } };
+}
+
+void GameCollection::CompactNamesIfSparse()
+{
+        if (garbage_name_bytes_ * 2 <= name_arena_.size()) {
+                return;
+        }
+        const char*       arena = name_arena_.data();
+        SharedArray<char> compacted;
+        compacted.reserve(name_arena_.size() - garbage_name_bytes_);
+        for (size_t i = 0; i < app_ids_.size(); ++i) {
+                const bool shared = lower_name_offsets_[i] == name_offsets_[i];
+                const auto offset = static_cast<std::uint32_t>(compacted.size());
+                compacted.append(arena + name_offsets_[i], name_lengths_[i]);
+                if (!shared) {
+                        const auto lower_offset = static_cast<std::uint32_t>(compacted.size());
+                        compacted.append(arena + lower_name_offsets_[i], lower_name_lengths_[i]);
+                        lower_name_offsets_[i] = lower_offset;
+                } else {
+                        lower_name_offsets_[i] = offset;
+                }
+                name_offsets_[i] = offset;
+        }
+        name_arena_ = std::move(compacted);
+        garbage_name_bytes_ = 0;
+}
+
+const std::vector<size_t>& GameCollection::NameOrder() const
+{
+        if (name_order_version_ != names_version_) {
+                name_order_.resize(size());
+                std::iota(name_order_.begin(), name_order_.end(), 0);
+                std::stable_sort(name_order_.begin(), name_order_.end(), [this](size_t a, size_t b) {
+                        return LowerName(a) < LowerName(b);
+                });
+                name_order_version_ = names_version_;
+        }
+        return name_order_;
+}
+
+const std::vector<size_t>& GameCollection::PlaytimeOrder() const
+{
+        if (playtime_order_names_version_ == names_version_ && playtime_order_version_ == playtime_version_) {
+                return playtime_order_;
+        }
+        playtime_order_ = NameOrder();
+
+        /* * LSD radix sort, one byte per pass. Inverting the sign-flipped value makes ascending key order
+         * * descending playtime, and each stable pass keeps name order among equal playtimes. */
+        const auto key = [this](size_t index) {
+                return ~(static_cast<std::uint32_t>(playtimes_[index]) ^ 0x80000000u);
+        };
+        std::vector<size_t> scratch(playtime_order_.size());
+        for (unsigned shift = 0; shift < 32; shift += 8) {
+                size_t bucket_starts[257] = {};
+                for (size_t index : playtime_order_) {
+                        ++bucket_starts[((key(index) >> shift) & 0xFF) + 1];
+                }
+                /* * Playtimes rarely use the high bytes; a pass where all keys share a byte would move nothing. */
+                if (std::find(std::begin(bucket_starts) + 1, std::end(bucket_starts), playtime_order_.size())
+                    != std::end(bucket_starts)) {
+                        continue;
+                }
+                std::partial_sum(std::begin(bucket_starts), std::end(bucket_starts), std::begin(bucket_starts));
+                for (size_t index : playtime_order_) {
+                        scratch[bucket_starts[(key(index) >> shift) & 0xFF]++] = index;
+                }
+                playtime_order_.swap(scratch);
+        }
+        playtime_order_names_version_ = names_version_;
+        playtime_order_version_       = playtime_version_;
+        return playtime_order_;
+}
+
+} // namespace data
+STEAM_END_NAMESPACE
@@ -1,17 +1,37 @@
 // src/steam/graph.cpp
 #include "steam/graph.hpp"
 
+#include "steam/loader.hpp"  // For QueueRelationEdit and QueueRelationsFile
 #include "steam/utility.hpp" // For GetGamesDataPath or similar for relations file
 // #include "steam/loader.hpp"  // For nlohmann::json, already included via data.hpp->base.hpp
 #include "steam/data.hpp" // For kDataDirectory, fmt, nlohmann::json
 
 #include <algorithm> // for std::remove, std::min etc.
+#include <cstdio>    // for the journal's FILE handle and std::sscanf
 #include <fstream>
+#include <iterator> // for std::back_inserter
 
 STEAM_BEGIN_NAMESPACE
 namespace graph {
 std::unordered_map<int, std::unordered_set<int>> steam_game_relations_graph;
 
+// Counters behind compaction; the journal file itself is only opened by the save worker
+struct RelationsJournal
+{
+        size_t records    = 0; // Edits replayed or made since the last compaction
+        size_t compact_at = kRelationsCompactMinRecords;
+};
+static RelationsJournal relations_journal;
+
+static size_t CountRelations()
+{
+        size_t endpoints = 0;
+        for (const auto& pair : steam_game_relations_graph) {
+                endpoints += pair.second.size();
+        }
+        return endpoints / 2;
+}
+
 std::filesystem::path GetRelationsDataPath()
 {
         std::filesystem::path data_dir_path = kDataDirectory; // from data.hpp
@@ -21,6 +41,11 @@ std::filesystem::path GetRelationsDataPath()
         return data_dir_path / kRelationsJsonFile;
 }
 
+std::filesystem::path GetRelationsJournalPath()
+{
+        return GetRelationsDataPath().parent_path() / kRelationsJournalFile;
+}
+
 void AddRelation(int app_id1, int app_id2)
 {
         if (app_id1 == app_id2)
@@ -58,28 +83,109 @@ std::vector<int> GetRelatedGames(int app_id, int max_recommendations)
         return related;
 }
 
-void SaveRelations()
+static bool HasRelation(int app_id1, int app_id2)
 {
-        std::filesystem::path relations_file_path = GetRelationsDataPath();
-        std::ofstream         ofs(relations_file_path);
+        auto it = steam_game_relations_graph.find(app_id1);
+        return it != steam_game_relations_graph.end() && it->second.count(app_id2) > 0;
+}
 
-        if (!ofs.is_open()) {
-                fmt::print(
-                    fmt::fg(fmt::color::indian_red),
-                    "Error: Could not open {} for writing.\n",
-                    relations_file_path.string());
-                return;
+void EditRelation(RelationEdit edit, int app_id1, int app_id2)
+{
+        const bool was_set = HasRelation(app_id1, app_id2);
+        if (edit == RelationEdit::ADD) {
+                AddRelation(app_id1, app_id2);
+        } else {
+                RemoveRelation(app_id1, app_id2);
+        }
+        loader::QueueRelationEdit({ edit, app_id1, app_id2 }, was_set);
+        if (++relations_journal.records >= relations_journal.compact_at) {
+                SaveRelations();
         }
+}
+
+bool AppendRelationRecords(const std::vector<RelationRecord>& records)
+{
+        std::string lines;
+        for (const RelationRecord& record : records) {
+                fmt::format_to(
+                    std::back_inserter(lines),
+                    "{} {} {}\n",
+                    record.edit == RelationEdit::ADD ? '+' : '-',
+                    record.app_id1,
+                    record.app_id2);
+        }
+        std::FILE* file = OpenFile(GetRelationsJournalPath(), "ab");
+        if (file == nullptr) {
+                return false;
+        }
+        const bool written = std::fwrite(lines.data(), 1, lines.size(), file) == lines.size()
+                             && FlushFileToDisk(file);
+        std::fclose(file);
+        return written;
+}
 
+void SaveRelations()
+{
         nlohmann::json json_output;
         for (const auto& pair : steam_game_relations_graph) {
                 json_output[std::to_string(pair.first)] = pair.second;
         }
-        ofs << json_output.dump(4);
-        ofs.close();
+        loader::QueueRelationsFile(json_output.dump(4));
+        relations_journal.records    = 0;
+        relations_journal.compact_at = std::max(kRelationsCompactMinRecords, 2 * CountRelations());
 }
 
-void LoadRelations()
+bool WriteRelationsFile(const std::string& text)
+{
+        const bool written = WriteFileAtomically(GetRelationsDataPath(), [&text](std::FILE* file) {
+                return std::fwrite(text.data(), 1, text.size(), file) == text.size();
+        });
+        if (!written) {
+                return false;
+        }
+
+        // relations.json now holds every journaled edit, so the journal starts over. The save worker appends
+        // the edits made before the compaction first, so if the process dies before the truncation lands, the
+        // journal ends with the state of every pair it names and replaying it over the new snapshot is harmless.
+        // The truncation is flushed before any later edit is appended behind it.
+        if (std::FILE* emptied = OpenFile(GetRelationsJournalPath(), "wb")) {
+                FlushFileToDisk(emptied);
+                std::fclose(emptied);
+        }
+        return true;
+}
+
+// Applies relations.log on top of the loaded snapshot.
+// @return False if the last line was cut short by a crash and should be compacted away.
+static bool ReplayRelationsJournal()
+{
+        std::ifstream ifs(GetRelationsJournalPath());
+        if (!ifs.is_open()) {
+                return true;
+        }
+        std::string line;
+        while (std::getline(ifs, line)) {
+                if (ifs.eof()) {
+                        return false; // No trailing newline: the append was torn mid-write
+                }
+                char edit    = 0;
+                int  app_id1 = 0;
+                int  app_id2 = 0;
+                if (std::sscanf(line.c_str(), "%c %d %d", &edit, &app_id1, &app_id2) != 3) {
+                        continue;
+                }
+                if (edit == '+') {
+                        AddRelation(app_id1, app_id2);
+                } else if (edit == '-') {
+                        RemoveRelation(app_id1, app_id2);
+                }
+                ++relations_journal.records;
+        }
+        return true;
+}
+
+// Reads relations.json into the graph.
+static void LoadRelationsSnapshot()
 {
         std::filesystem::path relations_file_path = GetRelationsDataPath();
         if (!std::filesystem::exists(relations_file_path)) {
@@ -128,5 +234,17 @@ void LoadRelations()
                 }
         }
 }
+
+void LoadRelations()
+{
+        steam_game_relations_graph.clear();
+        relations_journal.records = 0;
+        LoadRelationsSnapshot();
+        const bool intact            = ReplayRelationsJournal();
+        relations_journal.compact_at = std::max(kRelationsCompactMinRecords, 2 * CountRelations());
+        if (!steam_read_only && (!intact || relations_journal.records >= relations_journal.compact_at)) {
+                SaveRelations();
+        }
+}
 } // namespace graph
 STEAM_END_NAMESPACE
\ No newline at end of file
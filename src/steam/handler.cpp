@@ -1,26 +1,262 @@
 #include "steam/handler.hpp"
-#include <numeric>
+#include <atomic>
+#include <ctime> // For std::time, std::localtime
+#include <fmt/chrono.h>
+#include <fstream>
+#include <future> // For std::async in RunConcurrently
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <unordered_set>
 
 using json = nlohmann::json;
 using namespace fmt;
 STEAM_BEGIN_NAMESPACE
 
 namespace handler {
+
+/**
+ * @brief SAX handler that reads a GetOwnedGames response straight into a GameCollection.
+ * * Keeps response.game_count (to reserve the columns) and the appid, name and playtime_forever of every
+ * * response.games entry, with the DOM parse's defaults for missing fields; every other value is skipped
+ * * without being stored.
+ */
+class OwnedGamesReader : public nlohmann::json_sax<json>
+{
+      public:
+        explicit OwnedGamesReader(data::GameCollection& games) : games_(games) {}
+
+        /* * False if the response had no games array at all, as for a private profile. */
+        bool HasGameList() const
+        {
+                return has_game_list_;
+        }
+        const std::string& Error() const
+        {
+                return error_;
+        }
+
+        bool null() override
+        {
+                return true;
+        }
+        bool boolean(bool) override
+        {
+                return true;
+        }
+        bool number_integer(number_integer_t value) override
+        {
+                return Number(value);
+        }
+        bool number_unsigned(number_unsigned_t value) override
+        {
+                return Number(static_cast<number_integer_t>(value));
+        }
+        bool number_float(number_float_t, const string_t&) override
+        {
+                return true;
+        }
+        bool string(string_t& value) override
+        {
+                if (InGame() && key_ == Key::NAME) {
+                        game_.name.assign(value);
+                }
+                return true;
+        }
+        bool binary(binary_t&) override
+        {
+                return true;
+        }
+        bool start_object(std::size_t) override
+        {
+                ++depth_;
+                if (depth_ == kResponseDepth && key_ == Key::RESPONSE) {
+                        in_response_ = true;
+                } else if (InGame()) {
+                        game_.name             = "Unnamed Game";
+                        game_.app_id           = 0;
+                        game_.playtime_forever = 0;
+                }
+                key_ = Key::OTHER;
+                return true;
+        }
+        bool end_object() override
+        {
+                if (InGame()) {
+                        games_.push_back(game_);
+                } else if (depth_ == kResponseDepth) {
+                        in_response_ = false;
+                }
+                --depth_;
+                key_ = Key::OTHER;
+                return true;
+        }
+        bool start_array(std::size_t) override
+        {
+                ++depth_;
+                if (in_response_ && depth_ == kGameListDepth && key_ == Key::GAMES) {
+                        in_game_list_  = true;
+                        has_game_list_ = true;
+                }
+                key_ = Key::OTHER;
+                return true;
+        }
+        bool end_array() override
+        {
+                if (depth_ == kGameListDepth) {
+                        in_game_list_ = false;
+                }
+                --depth_;
+                key_ = Key::OTHER;
+                return true;
+        }
+        bool key(string_t& name) override
+        {
+                key_ = name == "response"           ? Key::RESPONSE
+                       : name == "game_count"       ? Key::GAME_COUNT
+                       : name == "games"            ? Key::GAMES
+                       : name == "appid"            ? Key::APP_ID
+                       : name == "name"             ? Key::NAME
+                       : name == "playtime_forever" ? Key::PLAYTIME
+                                                    : Key::OTHER;
+                return true;
+        }
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& error) override
+        {
+                error_ = error.what();
+                return false;
+        }
+
+      private:
+        enum class Key
+        {
+                OTHER,
+                RESPONSE,
+                GAME_COUNT,
+                GAMES,
+                APP_ID,
+                NAME,
+                PLAYTIME,
+        };
+        /* * Nesting of {"response": {"games": [{...}]}}: the root object is depth 1. */
+        static constexpr int kResponseDepth = 2;
+        static constexpr int kGameListDepth = 3;
+        static constexpr int kGameDepth     = 4;
+        /* * game_count is only trusted this far for reserving; a larger library still loads, just growing. */
+        static constexpr number_integer_t kMaxReservedGames = 1 << 22;
+
+        bool InGame() const
+        {
+                return in_game_list_ && depth_ == kGameDepth;
+        }
+        bool Number(number_integer_t value)
+        {
+                if (InGame() && key_ == Key::APP_ID) {
+                        game_.app_id = static_cast<int>(value);
+                } else if (InGame() && key_ == Key::PLAYTIME) {
+                        game_.playtime_forever = static_cast<int>(value);
+                } else if (in_response_ && depth_ == kResponseDepth && key_ == Key::GAME_COUNT && value > 0) {
+                        games_.reserve(static_cast<size_t>(std::min(value, kMaxReservedGames)));
+                }
+                return true;
+        }
+
+        data::GameCollection& games_;
+        data::GameData        game_;
+        std::string           error_;
+        Key                   key_           = Key::OTHER;
+        int                   depth_         = 0;
+        bool                  in_response_   = false;
+        bool                  in_game_list_  = false;
+        bool                  has_game_list_ = false;
+};
+
+/**
+ * @brief Reports a key the API refused even though it passed the startup check, e.g. one revoked since.
+ * * The key is cached as invalid and cleared, so the next 'fetch' asks for a new one.
+ * @return True if status means the key was refused.
+ */
+static bool ReportRejectedKey(int status)
+{
+        if (status != 401 && status != 403) {
+                return false;
+        }
+        print(
+            fg(color::indian_red),
+            "Error: Steam API refused the API key (status {}); 'fetch' will ask for a new one.\n",
+            status);
+        api_key::RecordRejectedKey(steam_api_key);
+        steam_api_key.clear();
+        return true;
+}
+
+/* * Formats a signed number of minutes as +H:MM or -H:MM. */
+static std::string FormatPlaytimeChange(long long minutes)
+{
+        const long long magnitude = minutes < 0 ? -minutes : minutes;
+        return format("{}{}:{:0>2}", minutes < 0 ? '-' : '+', magnitude / 60, magnitude % 60);
+}
+
+/* * Prints what a re-fetch changed, listing up to kFetchDiffLineLimit games of each kind. */
+static void PrintLibraryDiff(const catalog::LibraryDiff& diff)
+{
+        if (diff.ChangeCount() == 0) {
+                print(fg(color::light_green), "No changes since the last fetch; no index was touched.\n");
+                return;
+        }
+        print(
+            fg(color::cyan),
+            "Changes since the last fetch: {} added, {} removed, {} playtime, {} renamed.\n",
+            diff.added.size(),
+            diff.removed.size(),
+            diff.playtime_changes.size(),
+            diff.renamed.size());
+        for (size_t i = 0; i < diff.added.size() && i < kFetchDiffLineLimit; ++i) {
+                print(fg(color::light_green), "  + {} ({})\n", diff.added[i].name, diff.added[i].app_id);
+        }
+        for (size_t i = 0; i < diff.removed.size() && i < kFetchDiffLineLimit; ++i) {
+                print(fg(color::indian_red), "  - {} ({})\n", diff.removed[i].name, diff.removed[i].app_id);
+        }
+        for (size_t i = 0; i < diff.playtime_changes.size() && i < kFetchDiffLineLimit; ++i) {
+                const catalog::PlaytimeChange& change = diff.playtime_changes[i];
+                print(
+                    fg(color::white),
+                    "  ~ {}: {}:{:0>2} -> {}:{:0>2} ({})\n",
+                    change.name,
+                    change.old_playtime / 60,
+                    change.old_playtime % 60,
+                    change.new_playtime / 60,
+                    change.new_playtime % 60,
+                    FormatPlaytimeChange(static_cast<long long>(change.new_playtime) - change.old_playtime));
+        }
+        for (size_t i = 0; i < diff.renamed.size() && i < kFetchDiffLineLimit; ++i) {
+                print(fg(color::white), "  * {} -> {}\n", diff.renamed[i].old_name, diff.renamed[i].new_name);
+        }
+        const size_t listed_limit = std::max(
+            { diff.added.size(), diff.removed.size(), diff.playtime_changes.size(), diff.renamed.size() });
+        if (listed_limit > kFetchDiffLineLimit) {
+                print(fg(color::yellow), "  (at most {} shown per kind)\n", kFetchDiffLineLimit);
+        }
+        if (diff.rebuilt) {
+                print(fg(color::yellow), "Too many changes to apply one by one; the indexes were rebuilt.\n");
+        } else {
+                print(fg(color::cyan), "Index entries touched: {}.\n", diff.index_entries);
+        }
+}
+
 bool FetchGamesFromSteamApi(const std::string& steam_id_or_vanity_url) // Implementation already here
 {
+        /* * A re-fetch of the same account is applied as a diff rather than a reload. */
+        const std::string previous_steam_id = steam_has_fetched_data ? steam_current_user_data.steam_id : "";
 
         if (steam_api_key.empty()) {
                 print(fg(color::indian_red), "Error: Steam API key is not set. Configure .env file or enter key.\n");
-                if (!api_key::LoadApiKeyFromEnv()) { // Attempt to load/prompt again
+                if (!api_key::LoadApiKeyFromEnv(api_key::ReadEnvApiKey())) { // Attempt to load/prompt again
                         print(fg(color::indian_red), "API key still not available. Fetch aborted.\n");
                         return false;
                 }
         }
 
-        httplib::Client steam_api_client("api.steampowered.com");
-        steam_api_client.set_connection_timeout(10, 0); // 10s connection timeout
-        // steam_api_client.set_follow_location(true); // Good for redirects if any
-
         std::string resolved_steam_id = steam_id_or_vanity_url;
 
         // Try to resolve if it's not a 17-digit number (potential vanity URL)
@@ -29,10 +265,11 @@ bool FetchGamesFromSteamApi(const std::string& steam_id_or_vanity_url) // Implem
                 print("Attempting to resolve vanity URL: {}\n", steam_id_or_vanity_url);
                 std::string vanity_url_name = steam_id_or_vanity_url; // Assume it's a vanity URL
                 std::string resolve_vanity_path =
-                    format("/ISteamUser/ResolveVanityURL/v0001/?key={}&vanityurl={}", steam_api_key, vanity_url_name);
+                    format("/ISteamUser/ResolveVanityURL/v0001/?key={}&vanityurl={}",
+                           steam_api_key,
+                           EncodeUrlComponent(vanity_url_name));
 
-                steam_api_client.set_read_timeout(15, 0); // 15s read timeout
-                auto response = steam_api_client.Get(resolve_vanity_path.c_str());
+                auto response = api_client::Get(resolve_vanity_path, 15); // 15s read timeout
 
                 if (!response) {
                         print(
@@ -41,6 +278,9 @@ bool FetchGamesFromSteamApi(const std::string& steam_id_or_vanity_url) // Implem
                         return false;
                 }
                 if (response->status != 200) {
+                        if (ReportRejectedKey(response->status)) {
+                                return false;
+                        }
                         print(
                             fg(color::indian_red),
                             "Error: Steam API returned status {} for vanity URL resolution.\n",
@@ -71,22 +311,26 @@ bool FetchGamesFromSteamApi(const std::string& steam_id_or_vanity_url) // Implem
 
         /* * Fetch player summary */
         print("Fetching player summary for SteamID: {}\n", resolved_steam_id);
-        steam_api_client.set_read_timeout(15, 0); // Reset read timeout for next call
         std::string player_summary_path =
             format("/ISteamUser/GetPlayerSummaries/v0002/?key={}&steamids={}", steam_api_key, resolved_steam_id);
-        auto summary_response = steam_api_client.Get(player_summary_path.c_str());
+        auto summary_response = api_client::Get(player_summary_path, 15);
 
         if (!summary_response) {
                 print(fg(color::indian_red), "Error: Failed to connect to Steam API for player summaries.\n");
                 return false;
         }
         if (summary_response->status != 200) {
+                if (ReportRejectedKey(summary_response->status)) {
+                        return false;
+                }
                 print(
                     fg(color::indian_red),
                     "Error: Steam API returned status {} for player summaries.\n",
                     summary_response->status);
                 return false;
         }
+        /* * Becomes the current user only once its owned games arrive, so a failed fetch keeps the old labels. */
+        data::UserData fetched_user;
         try {
                 json summary_json = json::parse(summary_response->body);
                 if (!summary_json.contains("response") || !summary_json["response"].contains("players")
@@ -98,15 +342,15 @@ bool FetchGamesFromSteamApi(const std::string& steam_id_or_vanity_url) // Implem
                             resolved_steam_id);
                         return false;
                 }
-                auto player_data                 = summary_json["response"]["players"][0];
-                steam_current_user_data.steam_id = resolved_steam_id;
-                steam_current_user_data.username = player_data.value("personaname", "Unknown User");
-                steam_current_user_data.location = format(
+                auto player_data      = summary_json["response"]["players"][0];
+                fetched_user.steam_id = resolved_steam_id;
+                fetched_user.username = player_data.value("personaname", "Unknown User");
+                fetched_user.location = format(
                     "{}, {}",
                     player_data.value("locstatecode", "N/A"),
                     player_data.value("loccountrycode", "N/A"));
-                if (steam_current_user_data.location == "N/A, N/A")
-                        steam_current_user_data.location = "Unknown";
+                if (fetched_user.location == "N/A, N/A")
+                        fetched_user.location = "Unknown";
 
         } catch (const std::exception& e) {
                 print(fg(color::indian_red), "Error: Failed to parse user summary: {}.\n", e.what());
@@ -116,71 +360,81 @@ bool FetchGamesFromSteamApi(const std::string& steam_id_or_vanity_url) // Implem
         /* * Fetch owned games */
         print(
             "Fetching owned games for {} ({})...\n",
-            steam_current_user_data.username,
-            steam_current_user_data.steam_id);
-        steam_api_client.set_read_timeout(30, 0); // Games list can be larger, longer timeout
+            fetched_user.username,
+            fetched_user.steam_id);
         std::string owned_games_path = format(
             "/IPlayerService/GetOwnedGames/v0001/"
             "?key={}&steamid={}&format=json&include_appinfo=true", // include_appinfo=1 is fine, true is more
                                                                    // C++ like
             steam_api_key,
             resolved_steam_id);
-        auto games_response = steam_api_client.Get(owned_games_path.c_str());
+        /* * Parsed while it downloads, straight into columns; the body and a DOM of it are never held whole. */
+        data::GameCollection fetched_games;
+        OwnedGamesReader     owned_games_reader(fetched_games);
+        bool                 parsed = false;
+        /* * Games list can be larger, longer timeout */
+        auto games_response = api_client::GetStreamed(owned_games_path, 30, [&](std::istream& body) {
+                parsed = json::sax_parse(body, &owned_games_reader);
+        });
 
         if (!games_response) {
                 print(fg(color::indian_red), "Error: Failed to connect to Steam API for owned games.\n");
                 return false;
         }
         if (games_response->status != 200) {
+                if (ReportRejectedKey(games_response->status)) {
+                        return false;
+                }
                 print(
                     fg(color::indian_red),
                     "Error: Steam API returned status {} for owned games.\n",
                     games_response->status);
                 return false;
         }
+        if (!parsed) {
+                print(
+                    fg(color::indian_red),
+                    "Error: Failed to parse owned games response: {}.\n",
+                    owned_games_reader.Error());
+                return false;
+        }
+        if (!owned_games_reader.HasGameList()) {
+                /* * A private library is not stored: it would replace the saved one and read as every game removed. */
+                print(
+                    fg(color::yellow),
+                    "Warning: No game list for {} ({}); the profile might be private. Stored library kept.\n",
+                    fetched_user.username,
+                    fetched_user.steam_id);
+                return false;
+        }
+        steam_current_user_data = std::move(fetched_user);
         try {
-                json games_json = json::parse(games_response->body);
-                if (!games_json.contains("response") || !games_json["response"].contains("games")) {
-                        print(
-                            fg(color::yellow),
-                            "Warning: No games found in API response or profile might be private.\n");
-                        steam_has_fetched_data = true; // User data was fetched
-                        steam_game_collection.clear(); // Ensure game list is empty
-                        prefix::steam_game_name_prefix_tree.Clear();
-                        prefix::steam_game_name_to_index_map.clear();
-                        loader::SaveGamesDataToJson(); // Save the user data and empty game list
-                        return true;
-                }
-                auto game_list_json = games_json["response"]["games"];
-                if (game_list_json.empty()) {
+                if (fetched_games.empty()) {
                         print(
                             fg(color::yellow),
                             "Warning: Game list is empty. User may own no games or profile is private.\n");
                         steam_has_fetched_data = true;
-                        steam_game_collection.clear();
-                        prefix::steam_game_name_prefix_tree.Clear();
-                        prefix::steam_game_name_to_index_map.clear();
-                        loader::SaveGamesDataToJson();
+                        catalog::Clear();
+                        loader::SaveGamesData();
                         return true;
                 }
 
-                steam_game_collection.clear();
-                prefix::steam_game_name_prefix_tree.Clear();
-                prefix::steam_game_name_to_index_map.clear();
                 steam_has_fetched_data = true;
-                size_t current_index   = 0;
-
-                for (const auto& game_entry : game_list_json) {
-                        data::GameData game;
-                        game.name             = game_entry.value("name", "Unnamed Game");
-                        game.app_id           = game_entry.value("appid", 0);
-                        game.playtime_forever = game_entry.value("playtime_forever", 0);
-                        steam_game_collection.push_back(game);
-                        prefix::steam_game_name_prefix_tree.Insert(game.name, current_index);
-                        prefix::steam_game_name_to_index_map[ToLower(game.name)] = current_index;
-                        current_index++;
-                }
-                loader::SaveGamesDataToJson();
+
+                if (previous_steam_id == steam_current_user_data.steam_id && !steam_game_collection.empty()) {
+                        PrintLibraryDiff(catalog::ApplyFetchedGames(fetched_games));
+                } else {
+                        /* * Indexed in one bulk load, which large libraries spread over the cores. */
+                        catalog::LoadColumns(fetched_games.Columns());
+                }
+                loader::SaveGamesData();
+                if (!history::AppendPlaytimeSnapshot(
+                        steam_current_user_data.steam_id, steam_game_collection, std::time(nullptr))) {
+                        print(
+                            fg(color::yellow),
+                            "Warning: Could not record a playtime snapshot in {}.\n",
+                            GetPlaytimeHistoryPath().string());
+                }
                 print(
                     fg(color::light_green),
                     "Fetched {} games for {}.\n",
@@ -193,11 +447,366 @@ bool FetchGamesFromSteamApi(const std::string& steam_id_or_vanity_url) // Implem
                 return true;
 
         } catch (const std::exception& e) {
-                print(fg(color::indian_red), "Error: Failed to parse owned games response: {}.\n", e.what());
+                print(fg(color::indian_red), "Error: Failed to load owned games: {}.\n", e.what());
                 return false;
         }
 }
 
+/* * One account named to fetch-many, and how far its fetch got. */
+struct BatchAccount
+{
+        std::string          requested; /* * As given: a SteamID64 or a vanity name */
+        std::string          steam_id;  /* * Empty until resolved */
+        data::UserData       user;
+        data::GameCollection games;
+        std::string          error; /* * Why the account was not stored; empty once it was */
+        bool                 has_summary = false;
+        bool                 stored      = false;
+        bool                 reported    = false; /* * A progress line was printed for it */
+        bool                 skipped     = false; /* * Not requested because the API key was refused */
+};
+
+/* * Runs task(0) to task(count - 1) on up to worker_count threads; each thread takes the next index when free. */
+static void RunConcurrently(size_t count, size_t worker_count, const std::function<void(size_t)>& task)
+{
+        std::atomic<size_t>            next { 0 };
+        std::vector<std::future<void>> workers;
+        for (size_t worker = 0; worker < std::min(count, worker_count); ++worker) {
+                workers.push_back(std::async(std::launch::async, [&next, count, &task] {
+                        for (size_t index = next++; index < count; index = next++) {
+                                task(index);
+                        }
+                }));
+        }
+        for (auto& worker : workers) {
+                worker.get();
+        }
+}
+
+/* * SteamIDs and vanity names from fetch-many's arguments, each argument a name or a file listing them. */
+static std::vector<std::string> ReadBatchNames(const std::vector<std::string>& arguments)
+{
+        std::vector<std::string>        names;
+        std::unordered_set<std::string> seen;
+        auto                            add = [&names, &seen](const std::string& name) {
+                if (!name.empty() && seen.insert(name).second) {
+                        names.push_back(name);
+                }
+        };
+        for (const std::string& argument : arguments) {
+                std::error_code error;
+                if (!std::filesystem::is_regular_file(argument, error)) {
+                        add(argument);
+                        continue;
+                }
+                /* * One or more names per line, separated by spaces or commas; '#' starts a comment. */
+                std::ifstream file(argument);
+                std::string   line;
+                while (std::getline(file, line)) {
+                        line = line.substr(0, line.find('#'));
+                        std::replace(line.begin(), line.end(), ',', ' ');
+                        std::istringstream words(line);
+                        std::string        word;
+                        while (words >> word) {
+                                add(word);
+                        }
+                }
+        }
+        return names;
+}
+
+static bool IsSteamId64(const std::string& text)
+{
+        return text.length() == 17 && std::all_of(text.begin(), text.end(), ::isdigit);
+}
+
+void HandleFetchManyCommand(const std::vector<std::string>& arguments)
+{
+        const std::vector<std::string> names = ReadBatchNames(arguments);
+        if (names.empty()) {
+                print(fg(color::indian_red), "Error: No SteamIDs or vanity names to fetch.\n");
+                return;
+        }
+        const auto                  started         = std::chrono::steady_clock::now();
+        const api_client::PoolStats requests_before = api_client::GetPoolStats();
+        const size_t                worker_count    = api_client::PoolSize();
+        const std::string           api_key         = steam_api_key; /* * A refused key is reported at the end */
+
+        std::vector<BatchAccount> accounts(names.size());
+        std::vector<size_t>       vanity_accounts;
+        for (size_t index = 0; index < names.size(); ++index) {
+                accounts[index].requested = names[index];
+                if (IsSteamId64(names[index])) {
+                        accounts[index].steam_id = names[index];
+                } else {
+                        vanity_accounts.push_back(index);
+                }
+        }
+        print(
+            "Fetching {} account(s) over up to {} connection(s)...\n",
+            accounts.size(),
+            std::min(worker_count, accounts.size()));
+
+        std::mutex       output_mutex; /* * Serializes progress lines and the profile store */
+        std::atomic<int> refused_status { 0 };
+        auto             note_refusal = [&refused_status](int status) {
+                if (status == 401 || status == 403) {
+                        refused_status = status;
+                }
+        };
+
+        /* * Vanity names, concurrently. */
+        RunConcurrently(vanity_accounts.size(), worker_count, [&](size_t task) {
+                BatchAccount& account = accounts[vanity_accounts[task]];
+                if (refused_status != 0) {
+                        account.skipped = true;
+                        return;
+                }
+                auto response = api_client::Get(format("/ISteamUser/ResolveVanityURL/v0001/?key={}&vanityurl={}",
+                                                       api_key,
+                                                       EncodeUrlComponent(account.requested)),
+                                                15);
+                if (!response) {
+                        account.error = "could not connect to resolve the vanity name";
+                } else if (response->status != 200) {
+                        note_refusal(response->status);
+                        account.error = format("status {} resolving the vanity name", response->status);
+                } else {
+                        try {
+                                json vanity_json = json::parse(response->body);
+                                if (vanity_json.contains("response") && vanity_json["response"]["success"] == 1) {
+                                        account.steam_id = vanity_json["response"]["steamid"].get<std::string>();
+                                } else {
+                                        account.error = "vanity name not found";
+                                }
+                        } catch (const std::exception& e) {
+                                account.error = format("bad vanity response: {}", e.what());
+                        }
+                }
+        });
+        if (!vanity_accounts.empty()) {
+                const size_t resolved =
+                    std::count_if(vanity_accounts.begin(), vanity_accounts.end(), [&accounts](size_t index) {
+                            return !accounts[index].steam_id.empty();
+                    });
+                print("Resolved {} of {} vanity name(s).\n", resolved, vanity_accounts.size());
+        }
+
+        /* * Summaries, kPlayerSummaryBatchSize SteamIDs per request, the batches concurrently. */
+        std::unordered_map<std::string, std::vector<size_t>> accounts_by_id;
+        std::vector<std::string>                             ids;
+        for (size_t index = 0; index < accounts.size(); ++index) {
+                const std::string& steam_id = accounts[index].steam_id;
+                if (!steam_id.empty()) {
+                        auto& same_id = accounts_by_id[steam_id];
+                        if (same_id.empty()) {
+                                ids.push_back(steam_id);
+                        }
+                        same_id.push_back(index);
+                }
+        }
+        const size_t batch_count = (ids.size() + kPlayerSummaryBatchSize - 1) / kPlayerSummaryBatchSize;
+        RunConcurrently(batch_count, worker_count, [&](size_t batch) {
+                if (refused_status != 0) {
+                        return;
+                }
+                const size_t begin = batch * kPlayerSummaryBatchSize;
+                const size_t end   = std::min(begin + kPlayerSummaryBatchSize, ids.size());
+                std::string  joined_ids;
+                for (size_t id = begin; id < end; ++id) {
+                        joined_ids += (id == begin ? "" : ",") + ids[id];
+                }
+                auto response = api_client::Get(
+                    format("/ISteamUser/GetPlayerSummaries/v0002/?key={}&steamids={}", api_key, joined_ids), 15);
+                if (!response || response->status != 200) {
+                        if (response) {
+                                note_refusal(response->status);
+                        }
+                        const std::string error = response
+                                                      ? format("status {} for player summaries", response->status)
+                                                      : "could not connect for player summaries";
+                        for (size_t id = begin; id < end; ++id) {
+                                for (size_t index : accounts_by_id.at(ids[id])) {
+                                        accounts[index].error = error;
+                                }
+                        }
+                        return;
+                }
+                try {
+                        json summary_json = json::parse(response->body);
+                        for (const json& player : summary_json.at("response").at("players")) {
+                                auto same_id = accounts_by_id.find(player.value("steamid", ""));
+                                if (same_id == accounts_by_id.end()) {
+                                        continue;
+                                }
+                                data::UserData user;
+                                user.steam_id = same_id->first;
+                                user.username = player.value("personaname", "Unknown User");
+                                user.location = format(
+                                    "{}, {}",
+                                    player.value("locstatecode", "N/A"),
+                                    player.value("loccountrycode", "N/A"));
+                                if (user.location == "N/A, N/A")
+                                        user.location = "Unknown";
+                                for (size_t index : same_id->second) {
+                                        accounts[index].user        = user;
+                                        accounts[index].has_summary = true;
+                                }
+                        }
+                } catch (const std::exception& e) {
+                        for (size_t id = begin; id < end; ++id) {
+                                for (size_t index : accounts_by_id.at(ids[id])) {
+                                        accounts[index].error = format("bad player summaries: {}", e.what());
+                                }
+                        }
+                }
+        });
+        for (BatchAccount& account : accounts) {
+                if (!account.steam_id.empty() && !account.has_summary && account.error.empty()) {
+                        account.skipped = refused_status != 0;
+                        account.error   = "no player data; private profile or wrong SteamID";
+                }
+        }
+        if (!ids.empty()) {
+                print("Fetched {} player summaries in {} request(s).\n", ids.size(), batch_count);
+        }
+
+        /* * Owned games, one account per connection; each is stored as soon as it arrives. */
+        std::vector<size_t> to_fetch;
+        for (const auto& [steam_id, same_id] : accounts_by_id) {
+                if (accounts[same_id.front()].has_summary) {
+                        to_fetch.push_back(same_id.front());
+                }
+        }
+        std::sort(to_fetch.begin(), to_fetch.end());
+        size_t                        done_count = 0;
+        const std::int64_t            fetch_time = std::time(nullptr);
+        std::optional<data::UserData> current_user; /* * Set if the current account is in the batch */
+        data::GameCollection          current_games;
+        RunConcurrently(to_fetch.size(), worker_count, [&](size_t task) {
+                BatchAccount& account = accounts[to_fetch[task]];
+                if (refused_status != 0) {
+                        account.skipped = true;
+                        return;
+                }
+                OwnedGamesReader owned_games_reader(account.games);
+                bool             parsed   = false;
+                auto             response = api_client::GetStreamed(
+                    format(
+                        "/IPlayerService/GetOwnedGames/v0001/"
+                        "?key={}&steamid={}&format=json&include_appinfo=true",
+                        api_key,
+                        account.steam_id),
+                    30,
+                    [&](std::istream& body) {
+                            parsed = json::sax_parse(body, &owned_games_reader);
+                    });
+                if (!response) {
+                        account.error = "could not connect for owned games";
+                } else if (response->status != 200) {
+                        note_refusal(response->status);
+                        account.error = format("status {} for owned games", response->status);
+                } else if (!parsed) {
+                        account.error = format("bad owned games response: {}", owned_games_reader.Error());
+                } else if (!owned_games_reader.HasGameList()) {
+                        /* * Like 'fetch', a private library is not stored: it would read as every game removed. */
+                        account.error = "no game list; profile might be private";
+                }
+
+                std::lock_guard<std::mutex> lock(output_mutex);
+                ++done_count;
+                account.reported = true;
+                if (!account.error.empty()) {
+                        print(
+                            fg(color::indian_red),
+                            "[{}/{}] {} ({}): {}\n",
+                            done_count,
+                            to_fetch.size(),
+                            account.user.username,
+                            account.steam_id,
+                            account.error);
+                        return;
+                }
+                profile::steam_profile_store.StoreProfile(account.user, account.games);
+                const bool recorded = history::AppendPlaytimeSnapshot(account.steam_id, account.games, fetch_time);
+                const std::string history_note =
+                    recorded ? "" : format(" (playtime snapshot not recorded in {})", GetPlaytimeHistoryPath().string());
+                account.stored = true;
+                print(
+                    fg(recorded ? color::light_green : color::yellow),
+                    "[{}/{}] {} ({}): {} games{}\n",
+                    done_count,
+                    to_fetch.size(),
+                    account.user.username,
+                    account.steam_id,
+                    account.games.size(),
+                    history_note);
+                if (account.steam_id == steam_current_user_data.steam_id && steam_has_fetched_data) {
+                        current_user  = account.user;
+                        current_games = std::move(account.games);
+                }
+                account.games = data::GameCollection();
+        });
+        /* * Names that resolved to an account already in the batch share its outcome. */
+        for (const auto& [steam_id, same_id] : accounts_by_id) {
+                for (size_t index : same_id) {
+                        if (index != same_id.front() && accounts[index].has_summary) {
+                                accounts[index].stored  = accounts[same_id.front()].stored;
+                                accounts[index].skipped = accounts[same_id.front()].skipped;
+                                accounts[index].error   = accounts[same_id.front()].error;
+                        }
+                }
+        }
+
+        if (refused_status != 0) {
+                ReportRejectedKey(refused_status);
+        }
+        size_t stored_count = 0;
+        for (const BatchAccount& account : accounts) {
+                stored_count += account.stored ? 1 : 0;
+        }
+        if (current_user) {
+                /* * The current account was refetched too, so the library follows it like after 'fetch'. */
+                steam_current_user_data = *current_user;
+                const catalog::LibraryDiff diff = catalog::ApplyFetchedGames(current_games);
+                print(
+                    fg(color::cyan),
+                    "Current library ({}): {} change(s) applied.\n",
+                    steam_current_user_data.username,
+                    diff.ChangeCount());
+        }
+        if (stored_count > 0) {
+                loader::SaveProfileStore();
+                loader::SaveGamesData();
+        }
+
+        const std::chrono::duration<double> elapsed        = std::chrono::steady_clock::now() - started;
+        const api_client::PoolStats         requests_after = api_client::GetPoolStats();
+        print(
+            fg(stored_count == accounts.size() ? color::light_green : color::yellow),
+            "Stored {} of {} account(s) in {:.1f}s ({} requests, {} new connections).\n",
+            stored_count,
+            accounts.size(),
+            elapsed.count(),
+            requests_after.requests - requests_before.requests,
+            requests_after.connections_opened - requests_before.connections_opened);
+        /* * Accounts that failed before their owned games were requested had no progress line yet. */
+        size_t skipped_count = 0;
+        for (const BatchAccount& account : accounts) {
+                if (account.skipped) {
+                        ++skipped_count;
+                } else if (!account.stored && !account.reported) {
+                        print(fg(color::indian_red), "  {}: {}\n", account.requested, account.error);
+                }
+        }
+        if (skipped_count > 0) {
+                print(fg(color::indian_red), "  {} account(s) skipped once the API key was refused.\n", skipped_count);
+        }
+        if (stored_count > 0) {
+                print(fg(color::yellow), "Type 'profiles' to list them or 'profile switch <name>' to open one.\n");
+        }
+}
+
 void HandleSearchCommand(const std::string& name_prefix)
 {
         if (steam_game_collection.empty() && !steam_has_fetched_data) {
@@ -215,6 +824,7 @@ void HandleSearchCommand(const std::string& name_prefix)
         auto found_indices = prefix::steam_game_name_prefix_tree.SearchByPrefix(name_prefix);
         if (found_indices.empty()) {
                 print(fg(color::indian_red), "No games found matching prefix '{}'.\n", name_prefix);
+                HandleFuzzySearchCommand(name_prefix);
                 return;
         }
 
@@ -233,7 +843,7 @@ void HandleSearchCommand(const std::string& name_prefix)
         for (size_t index : found_indices) {
                 if (index < steam_game_collection.size()) {
                         const auto& game         = steam_game_collection[index];
-                        std::string display_name = game.name;
+                        std::string display_name(game.name);
                         if (display_name.length() > max_name_width - 3 && max_name_width > 3) {
                                 display_name = display_name.substr(0, max_name_width - 3) + "...";
                         }
@@ -267,8 +877,8 @@ void HandleCountPlayedCommand()
         }
 
         size_t played_count = 0;
-        for (const auto& game : steam_game_collection) {
-                if (game.playtime_forever > 0) {
+        for (int playtime_forever : steam_game_collection.PlaytimeColumn()) {
+                if (playtime_forever > 0) {
                         played_count++;
                 }
         }
@@ -304,8 +914,9 @@ void HandleExportToCsvCommand(const std::string& output_filename_base)
         }
 
         ofs << "AppID,Name,PlaytimeMinutes\n";
-        for (const auto& game : steam_game_collection) {
-                std::string csv_name = game.name;
+        for (size_t index = 0; index < steam_game_collection.size(); ++index) {
+                const auto  game     = steam_game_collection[index];
+                std::string csv_name(game.name);
                 size_t      pos      = csv_name.find('"');
                 while (pos != std::string::npos) {
                         csv_name.replace(pos, 1, "\"\"");
@@ -357,7 +968,7 @@ static void PrintGameTable(const std::vector<size_t>& indices_to_print, const st
         for (size_t index : indices_to_print) {
                 if (index < steam_game_collection.size()) {
                         const auto& game         = steam_game_collection[index];
-                        std::string display_name = game.name;
+                        std::string display_name(game.name);
                         if (display_name.length() > max_name_width - 3 && max_name_width > 3) {
                                 display_name = display_name.substr(0, max_name_width - 3) + "...";
                         }
@@ -377,7 +988,7 @@ static void PrintGameTable(const std::vector<size_t>& indices_to_print, const st
         print(fg(color::light_green), "Displayed {} games.\n", indices_to_print.size());
 }
 
-void HandleListGamesCommand(char list_format)
+void HandleTopSearchCommand(const std::string& name_prefix, size_t count, prefix::SearchRank rank)
 {
         if (steam_game_collection.empty() && !steam_has_fetched_data) {
                 print(fg(color::yellow), "No local game data. Use 'fetch <SteamID/VanityURL>' first.\n");
@@ -391,23 +1002,102 @@ void HandleListGamesCommand(char list_format)
                 return;
         }
 
-        std::vector<size_t> indices(steam_game_collection.size());
-        std::iota(indices.begin(), indices.end(), 0);
+        auto found_indices = prefix::steam_game_name_prefix_tree.TopByPrefix(name_prefix, count, rank);
+        if (found_indices.empty()) {
+                print(fg(color::indian_red), "No games found matching prefix '{}'.\n", name_prefix);
+                return;
+        }
+        PrintGameTable(
+            found_indices,
+            format(
+                "Top {} for '{}' ({}):",
+                count,
+                name_prefix,
+                rank == prefix::SearchRank::PLAYTIME ? "by playtime" : "by name"));
+}
 
-        std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b) {
-                return ToLower(steam_game_collection[a].name) < ToLower(steam_game_collection[b].name);
-        });
+void HandleFuzzySearchCommand(const std::string& search_term)
+{
+        if (steam_game_collection.empty()) {
+                print(fg(color::yellow), "No local game data. Use 'fetch <SteamID/VanityURL>' first.\n");
+                return;
+        }
+
+        const auto matches = prefix::steam_game_name_prefix_tree.FuzzySearch(
+            search_term, prefix::PrefixTree::DefaultFuzzyDistance(search_term.size()), kFuzzySearchResultLimit);
+        if (matches.empty()) {
+                print(fg(color::indian_red), "No games found close to '{}'.\n", search_term);
+                return;
+        }
+        std::vector<size_t> found_indices;
+        for (const auto& match : matches) {
+                found_indices.push_back(match.game_index);
+        }
+        PrintGameTable(found_indices, format("Closest matches for '{}':", search_term));
+}
+
+void HandleContainsSearchCommand(const std::string& search_text)
+{
+        if (steam_game_collection.empty()) {
+                print(fg(color::yellow), "No local game data. Use 'fetch <SteamID/VanityURL>' first.\n");
+                return;
+        }
+
+        auto found_indices = infix::steam_game_name_infix_index.SearchContaining(search_text);
+        if (found_indices.empty()) {
+                print(fg(color::indian_red), "No games found containing '{}'.\n", search_text);
+                return;
+        }
+        PrintGameTable(found_indices, format("Games containing '{}':", search_text));
+}
+
+void HandleWordSearchCommand(const std::vector<std::string>& words)
+{
+        if (steam_game_collection.empty()) {
+                print(fg(color::yellow), "No local game data. Use 'fetch <SteamID/VanityURL>' first.\n");
+                return;
+        }
+
+        std::string search_term;
+        for (const auto& word : words) {
+                search_term += (search_term.empty() ? "" : " ") + word;
+        }
+        auto found_indices = token::steam_game_name_token_index.SearchAllWords(search_term);
+        if (found_indices.empty()) {
+                print(fg(color::indian_red), "No games found with all of the words '{}'.\n", search_term);
+                HandleFuzzySearchCommand(search_term);
+                return;
+        }
+        PrintGameTable(found_indices, format("Games with all of the words '{}':", search_term));
+}
+
+void HandleListGamesCommand(char list_format)
+{
+        if (steam_game_collection.empty() && !steam_has_fetched_data) {
+                print(fg(color::yellow), "No local game data. Use 'fetch <SteamID/VanityURL>' first.\n");
+                return;
+        }
+        if (steam_game_collection.empty() && steam_has_fetched_data) {
+                print(
+                    fg(color::yellow),
+                    "No games found for the current user ({}). Profile might have been private during last fetch.\n",
+                    steam_current_user_data.username);
+                return;
+        }
+
+        /* * Both orders are cached by the collection and only re-sorted after it changes. */
+        const std::vector<size_t>& indices = steam_game_collection.NameOrder();
 
         switch (list_format) {
         case ' ': {
                 print(fg(color::gold) | emphasis::bold, "All Games (Alphabetical):\n");
                 size_t max_name_width = 0;
-                for (const auto& game : steam_game_collection) {
-                        max_name_width = std::max(max_name_width, game.name.length());
+                for (size_t index = 0; index < steam_game_collection.size(); ++index) {
+                        max_name_width = std::max(max_name_width, steam_game_collection.Name(index).length());
                 }
                 max_name_width = std::min(max_name_width + 2, static_cast<size_t>(50));
                 for (size_t index : indices) {
-                        std::string display_name = steam_game_collection[index].name;
+                        std::string display_name(steam_game_collection.Name(index));
                         if (display_name.length() > max_name_width - 3 && max_name_width > 3) {
                                 display_name = display_name.substr(0, max_name_width - 3) + "...";
                         }
@@ -419,23 +1109,15 @@ void HandleListGamesCommand(char list_format)
         case 'l':
                 PrintGameTable(indices, "All Games (Alphabetical by Name):");
                 break;
-        case 'p': {
-                std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b) {
-                        if (steam_game_collection[a].playtime_forever != steam_game_collection[b].playtime_forever) {
-                                return steam_game_collection[a].playtime_forever
-                                       > steam_game_collection[b].playtime_forever;
-                        }
-                        return ToLower(steam_game_collection[a].name) < ToLower(steam_game_collection[b].name);
-                });
-                PrintGameTable(indices, "All Games (Sorted by Playtime):");
+        case 'p':
+                PrintGameTable(steam_game_collection.PlaytimeOrder(), "All Games (Sorted by Playtime):");
                 break;
-        }
         case 'n': {
                 print(fg(color::gold) | emphasis::bold, "Games by Initial Letter:\n");
                 char   current_letter = 0;
                 size_t max_name_width = 0;
-                for (const auto& game : steam_game_collection) {
-                        max_name_width = std::max(max_name_width, game.name.length());
+                for (size_t index = 0; index < steam_game_collection.size(); ++index) {
+                        max_name_width = std::max(max_name_width, steam_game_collection.Name(index).length());
                 }
                 max_name_width = std::min(max_name_width + 4, static_cast<size_t>(40));
 
@@ -453,7 +1135,7 @@ void HandleListGamesCommand(char list_format)
                                 print(fg(color::cyan) | emphasis::bold, "-- {} --\n", first_char);
                                 current_letter = first_char;
                         }
-                        std::string display_name = game.name;
+                        std::string display_name(game.name);
                         if (display_name.length() > max_name_width - 3 && max_name_width > 3) {
                                 display_name = display_name.substr(0, max_name_width - 3) + "...";
                         }
@@ -471,9 +1153,200 @@ void HandleListGamesCommand(char list_format)
         }
 }
 
+/* * Lists the dirty stores with their change counters, or "none". */
+static std::string DescribeUnsavedStores()
+{
+        const std::pair<loader::Store, const char*> stores[] = {
+                { loader::Store::LIBRARY, "library" },
+                { loader::Store::PROFILES, "profiles" },
+                { loader::Store::RELATIONS, "relations" },
+        };
+        std::string unsaved;
+        for (const auto& [store, name] : stores) {
+                const loader::StoreVersion version = loader::GetStoreVersion(store);
+                if (version.Dirty()) {
+                        unsaved += format(
+                            "{}{} (v{}, saved v{})", unsaved.empty() ? "" : ", ", name, version.changed, version.saved);
+                }
+        }
+        return unsaved.empty() ? "none" : unsaved;
+}
+
+void HandleStatsCommand()
+{
+        const auto& tree = prefix::steam_game_name_prefix_tree;
+        print(fg(color::cyan) | emphasis::bold, "-- Library Stats --\n");
+        print(fg(color::white), "Games:             {}\n", steam_game_collection.size());
+        print(fg(color::white), "Prefix tree nodes: {}\n", tree.NodeCount());
+        print(fg(color::white), "Prefix tree bytes: {}\n", tree.MemoryUsage());
+        print(fg(color::white), "Infix trigrams:    {}\n", infix::steam_game_name_infix_index.GramCount());
+        print(fg(color::white), "Infix index bytes: {}\n", infix::steam_game_name_infix_index.MemoryUsage());
+        print(fg(color::white), "Indexed words:     {}\n", token::steam_game_name_token_index.WordCount());
+        print(fg(color::white), "Word index bytes:  {}\n", token::steam_game_name_token_index.MemoryUsage());
+        print(fg(color::white), "Stored profiles:   {}\n", profile::steam_profile_store.profiles_.size());
+        print(fg(color::white), "Distinct apps:     {}\n", profile::steam_profile_store.AppCount());
+        print(fg(color::white), "Profile bytes:     {}\n", profile::steam_profile_store.MemoryUsage());
+        if (steam_read_only) {
+                print(fg(color::white), "Shared file bytes: {}\n", snapshot::SharedSnapshotBytes());
+        }
+        const api_client::PoolStats http = api_client::GetPoolStats();
+        print(fg(color::white), "API requests:      {}\n", http.requests);
+        print(
+            fg(color::white),
+            "API handshakes:    {} ({} open, {} closed idle)\n",
+            http.connections_opened,
+            http.open,
+            http.idle_closed);
+        const loader::SaveCounts saves = loader::GetSaveCounts();
+        print(fg(color::white), "Files written:     {}\n", saves.written);
+        print(fg(color::white), "Unchanged, kept:   {}\n", saves.unchanged);
+        print(fg(saves.failed > 0 ? color::yellow : color::white), "Failed, queued:    {}\n", saves.failed);
+        print(fg(color::white), "Unsaved changes:   {}\n", DescribeUnsavedStores());
+        print(fg(color::cyan), "---------------------\n");
+}
+
+void HandleProfilesCommand()
+{
+        const auto& store = profile::steam_profile_store;
+        if (store.profiles_.empty()) {
+                print(fg(color::yellow), "No stored profiles. Use 'fetch <SteamID/VanityURL>' first.\n");
+                return;
+        }
+        print(fg(color::gold) | emphasis::bold, "Stored Profiles ({}):\n", store.profiles_.size());
+        print(fg(color::cyan), "  {:<18} {:<24} {:>7} {:>10}\n", "SteamID", "Username", "Games", "Hours");
+        print(fg(color::cyan), "  {:-<18} {:-<24} {:->7} {:->10}\n", "", "", "", "");
+        for (const auto& [steam_id, stored] : store.profiles_) {
+                long long total_minutes = 0;
+                for (int playtime : stored.playtimes) {
+                        total_minutes += playtime;
+                }
+                const bool active = steam_id == steam_current_user_data.steam_id;
+                print(
+                    active ? fg(color::light_green) : fg(color::white),
+                    "{} {:<18} {:<24} {:>7} {:>10}\n",
+                    active ? '*' : ' ',
+                    steam_id,
+                    stored.user.username,
+                    stored.app_indices.size(),
+                    total_minutes / 60);
+        }
+        print(fg(color::cyan), "--------------------------------------------------\n");
+}
+
+void HandleProfileSwitchCommand(const std::string& steam_id_or_username)
+{
+        if (!profile::ActivateProfile(steam_id_or_username)) {
+                print(
+                    fg(color::indian_red),
+                    "Error: No stored profile '{}'. Type 'profiles' to list them.\n",
+                    steam_id_or_username);
+                return;
+        }
+        print(
+            fg(color::light_green),
+            "Switched to {} ({} games) without refetching.\n",
+            steam_current_user_data.username,
+            steam_game_collection.size());
+}
+
+void HandleProfileInfoCommand(const std::string& steam_id_or_username)
+{
+        const auto&             store  = profile::steam_profile_store;
+        const profile::Profile* stored = store.FindProfile(steam_id_or_username);
+        if (stored == nullptr) {
+                print(
+                    fg(color::indian_red),
+                    "Error: No stored profile '{}'. Type 'profiles' to list them.\n",
+                    steam_id_or_username);
+                return;
+        }
+        long long total_minutes = 0;
+        size_t    played        = 0;
+        for (int playtime : stored->playtimes) {
+                total_minutes += playtime;
+                played += playtime > 0 ? 1 : 0;
+        }
+        print(fg(color::cyan) | emphasis::bold, "-- Profile {} --\n", stored->user.username);
+        print(fg(color::white), "SteamID:  {}\n", stored->user.steam_id);
+        print(fg(color::white), "Location: {}\n", stored->user.location);
+        print(fg(color::white), "Games:    {} ({} played)\n", stored->app_indices.size(), played);
+        print(fg(color::white), "Playtime: {}:{:0>2}\n", total_minutes / 60, total_minutes % 60);
+
+        /* * Positions into the profile's arrays, most played first. */
+        std::vector<size_t> top(stored->app_indices.size());
+        for (size_t game = 0; game < top.size(); ++game) {
+                top[game] = game;
+        }
+        const size_t shown = std::min(top.size(), kProfileTopGameCount);
+        std::partial_sort(top.begin(), top.begin() + shown, top.end(), [stored](size_t a, size_t b) {
+                return stored->playtimes[a] > stored->playtimes[b];
+        });
+        if (shown > 0) {
+                print(fg(color::cyan), "Most played:\n");
+        }
+        for (size_t rank = 0; rank < shown; ++rank) {
+                const size_t game = top[rank];
+                print(
+                    fg(color::white),
+                    "  {:<10} {:<40} {:>5}:{:0>2}\n",
+                    store.AppId(stored->app_indices[game]),
+                    store.AppName(stored->app_indices[game]),
+                    stored->playtimes[game] / 60,
+                    stored->playtimes[game] % 60);
+        }
+        print(fg(color::cyan), "---------------------\n");
+}
+
+void HandleProfileOwnersCommand(const std::string& game_identifier)
+{
+        const auto&   store     = profile::steam_profile_store;
+        std::uint32_t app_index = profile::ProfileStore::kNoApp;
+        /* * Only a whole number is an AppID; "7 Days to Die" is a name. */
+        if (!game_identifier.empty() && std::all_of(game_identifier.begin(), game_identifier.end(), ::isdigit)) {
+                try {
+                        app_index = store.FindApp(std::stoi(game_identifier));
+                } catch (const std::out_of_range&) {
+                        /* * Too long for an AppID; may still be a name */
+                }
+        }
+        for (std::uint32_t app = 0; app < store.AppCount() && app_index == profile::ProfileStore::kNoApp; ++app) {
+                if (CompareIgnoreCase(store.AppName(app), game_identifier) == 0) {
+                        app_index = app;
+                }
+        }
+        if (app_index == profile::ProfileStore::kNoApp) {
+                print(fg(color::yellow), "No stored profile owns '{}'.\n", game_identifier);
+                return;
+        }
+
+        print(
+            fg(color::gold) | emphasis::bold,
+            "Owners of {} ({}):\n",
+            store.AppName(app_index),
+            store.AppId(app_index));
+        size_t owners = 0;
+        for (const auto& [steam_id, stored] : store.profiles_) {
+                for (size_t game = 0; game < stored.app_indices.size(); ++game) {
+                        if (stored.app_indices[game] == app_index) {
+                                print(
+                                    fg(color::white),
+                                    "  {:<24} {:>5}:{:0>2}\n",
+                                    stored.user.username,
+                                    stored.playtimes[game] / 60,
+                                    stored.playtimes[game] % 60);
+                                ++owners;
+                                break;
+                        }
+                }
+        }
+        print(fg(color::cyan), "{} of {} stored profiles.\n", owners, store.profiles_.size());
+}
+
 void ShowHelp()
 {
-        if (steam_has_fetched_data && !steam_current_user_data.steam_id.empty()) {
+        if (!loader::IsDataLoaded()) {
+                print(fg(color::yellow), "\nThe library is still loading in the background.\n");
+        } else if (steam_has_fetched_data && !steam_current_user_data.steam_id.empty()) {
                 print(fg(color::cyan) | emphasis::bold, "\n-- Current Account --\n");
                 print(fg(color::white), "Username: {}\n", steam_current_user_data.username);
                 print(fg(color::white), "Location: {}\n", steam_current_user_data.location);
@@ -487,25 +1360,72 @@ void ShowHelp()
         print(fg(color::cyan) | emphasis::bold, "\n-- Commands --\n");
         print(
             "  fetch <SteamID>       - Fetch game data for a Steam user.\n"
+            "  fetch-many <file|SteamID>...\n"
+            "                        - Fetch many accounts in parallel into the stored profiles.\n"
             "  search <prefix>       - Search for games by name prefix.\n"
+            "  search <word> <word>...\n"
+            "                        - Search for games with all of the words, in any order.\n"
+            "  search --fuzzy <text> - Typo-tolerant search (also used when a prefix finds nothing).\n"
+            "  search --contains <text>\n"
+            "                        - Search for games whose names contain the text anywhere.\n"
+            "  search --top N [-p|-n] <prefix>\n"
+            "                        - Show the N most played (-p) or first by name (-n) matches.\n"
             "  count                 - Show counts of played/unplayed games.\n"
             "  list                  - Show all game names (alphabetical).\n"
             "  list -l               - Show AppID, name, playtime (name sort).\n"
             "  list -n               - Show name, AppID, grouped by first letter.\n"
             "  list -p               - Show AppID, name, playtime (playtime sort).\n"
             "  export <filename>     - Export games to data/exported/filename.csv.\n"
+            "  stats                 - Show library size and search index memory.\n"
+            "  save                  - Write pending changes now (otherwise saved once edits pause, and on exit).\n"
+            "  profiles              - List every fetched profile (* marks the current one).\n"
+            "  profile switch <SteamID|name>\n"
+            "                        - Make a stored profile current without refetching.\n"
+            "  profile info <SteamID|name>\n"
+            "                        - Show a stored profile's totals and most played games.\n"
+            "  profile owners <AppID|name>\n"
+            "                        - Show which stored profiles own a game.\n"
+            "  trend [days] [N]      - Show the N games played most in the last days (default {} and {}).\n"
             "  history [N]           - Show last N commands (default {}).\n"
             "  help                  - Show this help message.\n"
             "  exit                  - Exit the program.\n",
+            kDefaultTrendDays,
+            kTrendResultLimit,
             kDefaultHistoryDisplayCount);
         print(fg(color::cyan), "---------------------\n");
         print(
             fg(color::yellow),
             "  - Ensure STEAM_API_KEY is set in a '.env' file in the same "
             "directory as the executable, or enter it when prompted.\n");
-        print(fg(color::yellow), "  - Data is stored in: {}\n\n", GetGamesDataPath().string());
+        print(fg(color::yellow), "  - Set STEAM_COMPACT_JSON=1 there to save games.json without indentation.\n");
+        print(
+            fg(color::yellow),
+            "  - STEAM_HTTP_POOL_SIZE and STEAM_HTTP_IDLE_SECONDS size the API connection pool (default {}, {}s).\n",
+            api_client::kDefaultPoolSize,
+            api_client::kDefaultIdleSeconds);
+        print(
+            fg(color::yellow),
+            "  - Set STEAM_READ_ONLY=1 to share the saved library with other processes; changes are refused.\n");
+        print(
+            fg(color::yellow),
+            "  - Data is stored in: {} (exported as {})\n\n",
+            GetGamesSnapshotPath().string(),
+            GetGamesDataPath().string());
+}
+/**
+ * @brief Looks up a game by AppID through catalog::FindGameByAppId.
+ * @return A view of the game in steam_game_collection, or std::nullopt if the AppID is unknown.
+ */
+static std::optional<data::GameView> FindGameByAppId(int app_id)
+{
+        const size_t index = catalog::FindGameByAppId(app_id);
+        if (index == steam_game_collection.size()) {
+                return std::nullopt;
+        }
+        return steam_game_collection[index];
 }
-int ResolveGameToAppId(const std::string& identifier, std::string* found_game_name)
+
+int ResolveGameToAppId(const std::string& identifier, std::string* found_game_name, bool accept_closest_match)
 {
         if (identifier.empty()) {
                 print(fg(color::indian_red), "Error: Game identifier cannot be empty.\n");
@@ -515,41 +1435,54 @@ int ResolveGameToAppId(const std::string& identifier, std::string* found_game_na
         try {
                 int app_id = std::stoi(identifier);
                 // Check if this app_id exists in our collection
-                for (const auto& game : steam_game_collection) {
-                        if (game.app_id == app_id) {
-                                if (found_game_name)
-                                        *found_game_name = game.name;
-                                return app_id;
-                        }
+                if (auto game = FindGameByAppId(app_id)) {
+                        if (found_game_name)
+                                *found_game_name = game->name;
+                        return app_id;
                 }
                 print(fg(color::yellow), "AppID {} not found in the current fetched game list.\n", app_id);
                 return 0; // Not found in collection
         } catch (const std::invalid_argument&) {
                 // Not an integer, try as name
-                std::string lower_identifier = ToLower(identifier);
-
-                // First, try exact match (case-insensitive) using the map
-                auto map_it                  = prefix::steam_game_name_to_index_map.find(lower_identifier);
-                if (map_it != prefix::steam_game_name_to_index_map.end()) {
-                        size_t index = map_it->second;
-                        if (index < steam_game_collection.size()) {
-                                if (found_game_name)
-                                        *found_game_name = steam_game_collection[index].name;
-                                return steam_game_collection[index].app_id;
-                        }
+                // First, try exact match (case-insensitive) using the name lookup
+                const size_t exact_index = catalog::FindGameByName(identifier);
+                if (exact_index < steam_game_collection.size()) {
+                        if (found_game_name)
+                                *found_game_name = steam_game_collection[exact_index].name;
+                        return steam_game_collection[exact_index].app_id;
                 }
 
                 // Try prefix search if exact match fails
-                auto found_indices = prefix::steam_game_name_prefix_tree.SearchByPrefix(lower_identifier);
+                auto found_indices = prefix::steam_game_name_prefix_tree.SearchByPrefix(identifier);
                 if (found_indices.empty()) {
-                        print(fg(color::indian_red), "No game found matching '{}'.\n", identifier);
+                        // Fall back to typo-tolerant search; only accept a single closest candidate
+                        const auto matches = prefix::steam_game_name_prefix_tree.FuzzySearch(
+                            identifier, prefix::PrefixTree::DefaultFuzzyDistance(identifier.size()), 5);
+                        if (matches.empty()) {
+                                print(fg(color::indian_red), "No game found matching '{}'.\n", identifier);
+                                return 0;
+                        }
+                        const bool single_closest = matches.size() == 1 || matches[1].distance > matches[0].distance
+                                                    || matches[1].name_distance > matches[0].name_distance;
+                        if (single_closest && accept_closest_match) {
+                                const auto game = steam_game_collection[matches[0].game_index];
+                                print(fg(color::yellow), "Assuming \"{}\" for '{}'.\n", game.name, identifier);
+                                if (found_game_name)
+                                        *found_game_name = game.name;
+                                return game.app_id;
+                        }
+                        print(fg(color::yellow), "No exact match for '{}'. Did you mean:\n", identifier);
+                        for (const auto& match : matches) {
+                                const auto game = steam_game_collection[match.game_index];
+                                print(fg(color::white), "- \"{}\" (AppID: {})\n", game.name, game.app_id);
+                        }
                         return 0;
                 }
                 if (found_indices.size() > 1) {
                         // Check if one of the prefix matches is an exact match for the identifier (case-insensitive)
                         for (size_t index : found_indices) {
                                 if (index < steam_game_collection.size()
-                                    && ToLower(steam_game_collection[index].name) == lower_identifier) {
+                                    && CompareIgnoreCase(steam_game_collection.LowerName(index), identifier) == 0) {
                                         if (found_game_name)
                                                 *found_game_name = steam_game_collection[index].name;
                                         return steam_game_collection[index].app_id;
@@ -612,20 +1545,17 @@ void HandleRelateCommand(const std::string& game1_id_str, const std::string& gam
                 return;
         }
 
-        graph::AddRelation(app_id1, app_id2);
-        graph::SaveRelations();                        // Save immediately
+        graph::EditRelation(graph::RelationEdit::ADD, app_id1, app_id2);
         undo::PushAddRelationAction(app_id1, app_id2); // Push to undo stack
 
         // Ensure names are fetched for display if not provided by ID resolution (e.g. if ID was numeric)
         if (game1_name_resolved.empty()) { // Should be filled by ResolveGameToAppId
-                for (const auto& g : steam_game_collection)
-                        if (g.app_id == app_id1)
-                                game1_name_resolved = g.name;
+                if (auto g = FindGameByAppId(app_id1))
+                        game1_name_resolved = g->name;
         }
         if (game2_name_resolved.empty()) { // Should be filled by ResolveGameToAppId
-                for (const auto& g : steam_game_collection)
-                        if (g.app_id == app_id2)
-                                game2_name_resolved = g.name;
+                if (auto g = FindGameByAppId(app_id2))
+                        game2_name_resolved = g->name;
         }
 
         print(
@@ -649,15 +1579,14 @@ void HandleRecommendationsCommand(const std::string& game_id_str)
         }
 
         std::string game_name_resolved;
-        int         app_id = ResolveGameToAppId(game_id_str, &game_name_resolved);
+        int         app_id = ResolveGameToAppId(game_id_str, &game_name_resolved, true);
         if (app_id == 0) {
                 print(fg(color::indian_red), "Could not resolve game: '{}'.\n", game_id_str);
                 return;
         }
         if (game_name_resolved.empty()) { // Should be filled by ResolveGameToAppId
-                for (const auto& g : steam_game_collection)
-                        if (g.app_id == app_id)
-                                game_name_resolved = g.name;
+                if (auto g = FindGameByAppId(app_id))
+                        game_name_resolved = g->name;
         }
 
         std::vector<int> related_app_ids = graph::GetRelatedGames(app_id);
@@ -673,15 +1602,9 @@ void HandleRecommendationsCommand(const std::string& game_id_str)
 
         print(fg(color::gold) | emphasis::bold, "Recommendations for \"{}\" (AppID {}):\n", game_name_resolved, app_id);
         for (int related_id : related_app_ids) {
-                bool found_in_collection = false;
-                for (const auto& game : steam_game_collection) {
-                        if (game.app_id == related_id) {
-                                print(fg(color::white), "- \"{}\" (AppID: {})\n", game.name, game.app_id);
-                                found_in_collection = true;
-                                break;
-                        }
-                }
-                if (!found_in_collection) {
+                if (auto game = FindGameByAppId(related_id)) {
+                        print(fg(color::white), "- \"{}\" (AppID: {})\n", game->name, game->app_id);
+                } else {
                         // This case should be rare if relations are only made between known games,
                         // but could happen if data/relations.json is manually edited or games are removed from
                         // collection.
@@ -697,5 +1620,129 @@ void HandleUndoCommand()
         // Message is printed by PopAndExecuteUndo
 }
 
+void HandleSaveCommand()
+{
+        if (steam_read_only) {
+                print(fg(color::yellow), "Nothing to save: STEAM_READ_ONLY=1 never writes.\n");
+                return;
+        }
+        const loader::SaveCounts before = loader::GetSaveCounts();
+        loader::FlushPendingSaves();
+        loader::ReportSaveFailures();
+        const loader::SaveCounts after = loader::GetSaveCounts();
+        if (after.written == before.written && after.unchanged == before.unchanged && after.failed == before.failed) {
+                print(fg(color::light_green), "Everything was already saved.\n");
+                return;
+        }
+        if (after.failed != before.failed) {
+                print(
+                    fg(color::yellow),
+                    "Saved: {} file(s) written, {} already up to date, {} failed and stay queued.\n",
+                    after.written - before.written,
+                    after.unchanged - before.unchanged,
+                    after.failed - before.failed);
+                return;
+        }
+        print(
+            fg(color::light_green),
+            "Saved: {} file(s) written, {} already up to date.\n",
+            after.written - before.written,
+            after.unchanged - before.unchanged);
+}
+
+/* * Formats a Unix time as a local date and time. */
+static std::string FormatSnapshotTime(std::int64_t timestamp)
+{
+        const std::time_t time  = static_cast<std::time_t>(timestamp);
+        const std::tm*    local = std::localtime(&time);
+        return local != nullptr ? format("{:%Y-%m-%d %H:%M}", *local) : std::to_string(timestamp);
+}
+
+void HandleTrendCommand(int days, size_t count)
+{
+        if (!steam_has_fetched_data || steam_current_user_data.steam_id.empty()) {
+                print(fg(color::yellow), "No local game data. Use 'fetch <SteamID/VanityURL>' first.\n");
+                return;
+        }
+        const std::int64_t     now          = std::time(nullptr);
+        const std::int64_t     window_start = now - std::int64_t{ days } * 86400;
+        history::PlaytimeTrend trend;
+        if (!history::ComputePlaytimeTrend(steam_current_user_data.steam_id, window_start, now, trend)) {
+                print(fg(color::yellow), "No playtime history yet. Every 'fetch' records a snapshot.\n");
+                return;
+        }
+        if (trend.history_start >= 0) {
+                print(
+                    fg(color::yellow),
+                    "History for {} starts at {}; playtime before that is not counted.\n",
+                    steam_current_user_data.username,
+                    FormatSnapshotTime(trend.history_start));
+        }
+        if (trend.snapshots == 0) {
+                print(
+                    fg(color::yellow),
+                    "No playtime changes recorded for {} in the last {} days. Fetch again later to compare.\n",
+                    steam_current_user_data.username,
+                    days);
+                return;
+        }
+
+        /* * Negative changes are games that left the library; only gains count as played. */
+        long long total_minutes = 0;
+        size_t    played_games  = 0;
+        for (const auto& change : trend.changes) {
+                if (change.minutes > 0) {
+                        total_minutes += change.minutes;
+                        ++played_games;
+                }
+        }
+        /* * The first snapshot holds all play since the one before it, which can be older than the window;
+         * * the header shows the span measured, and only a sizeable overhang is called out. */
+        const std::int64_t span_start = trend.span_start >= 0 ? trend.span_start : trend.first_time;
+        if (window_start - span_start > (now - window_start) / 4) {
+                print(
+                    fg(color::yellow),
+                    "The first snapshot in the {}-day window also covers play since {}.\n",
+                    days,
+                    FormatSnapshotTime(span_start));
+        }
+        print(
+            fg(color::gold) | emphasis::bold,
+            "Playtime for {} from {} to {} ({} snapshots):\n",
+            steam_current_user_data.username,
+            FormatSnapshotTime(span_start),
+            FormatSnapshotTime(trend.last_time),
+            trend.snapshots);
+        print(fg(color::cyan), "{:<10} {:<40} {:>10}\n", "AppID", "Name", "Change");
+        print(fg(color::cyan), "{:-<10} {:-<40} {:->10}\n", "", "", "");
+        for (size_t rank = 0; rank < trend.changes.size() && rank < count; ++rank) {
+                const auto& change = trend.changes[rank];
+                std::string name   = "Unknown Game";
+                if (auto game = FindGameByAppId(change.app_id)) {
+                        name = game->name;
+                } else {
+                        const std::uint32_t app_index = profile::steam_profile_store.FindApp(change.app_id);
+                        if (app_index != profile::ProfileStore::kNoApp) {
+                                name = std::string(profile::steam_profile_store.AppName(app_index));
+                        }
+                }
+                if (name.length() > 40) {
+                        name = name.substr(0, 37) + "...";
+                }
+                print(
+                    fg(color::white),
+                    "{:<10} {:<40} {:>10}\n",
+                    change.app_id,
+                    name,
+                    FormatPlaytimeChange(change.minutes));
+        }
+        print(fg(color::cyan), "--------------------------------------------------\n");
+        print(
+            fg(color::white),
+            "Total: {} across {} games.\n",
+            FormatPlaytimeChange(total_minutes),
+            played_games);
+}
+
 } // namespace handler
 STEAM_END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include "steam/history.hpp"
+
+#include "steam/mapped_file.hpp"
+#include "steam/utility.hpp" // For GetPlaytimeHistoryPath, OpenFile, FlushFileToDisk
+
+#include <algorithm> // For std::all_of, std::sort
+#include <cctype>    // For std::isdigit
+#include <cstring>   // For std::memcpy, std::memcmp
+#include <type_traits>
+#include <unordered_map>
+
+STEAM_BEGIN_NAMESPACE
+namespace history {
+
+static constexpr char          kRecordMagic[4] = { 'P', 'L', 'A', 'Y' };
+static constexpr std::uint32_t kBaselineFlag   = 1; /* * Deltas are against zero: the account's first snapshot */
+
+struct RecordHeader
+{
+        char          magic[4];
+        std::uint32_t flags;
+        std::uint64_t steam_id;
+        std::int64_t  timestamp;    /* * Unix time of the fetch */
+        std::uint32_t entry_count;  /* * Changed games in the payload */
+        std::uint32_t payload_size; /* * Bytes of payload after this header */
+        std::uint64_t checksum;     /* * FNV-1a of the payload */
+};
+static_assert(std::is_trivially_copyable_v<RecordHeader>, "Record headers are written and read with memcpy");
+
+static std::uint64_t Checksum(std::string_view bytes)
+{
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        for (char byte : bytes) {
+                hash = (hash ^ static_cast<unsigned char>(byte)) * 0x100000001B3ull;
+        }
+        return hash;
+}
+
+static bool ParseSteamId(const std::string& steam_id, std::uint64_t& value)
+{
+        if (steam_id.empty() || steam_id.size() > 19
+            || !std::all_of(steam_id.begin(), steam_id.end(), [](unsigned char ch) {
+                       return std::isdigit(ch);
+               })) {
+                return false;
+        }
+        value = std::stoull(steam_id);
+        return true;
+}
+
+static void AppendVarint(std::string& bytes, std::uint64_t value)
+{
+        while (value >= 0x80) {
+                bytes.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+        }
+        bytes.push_back(static_cast<char>(value));
+}
+
+static bool ReadVarint(const char*& cursor, const char* end, std::uint64_t& value)
+{
+        value = 0;
+        for (unsigned shift = 0; cursor < end && shift < 64; shift += 7) {
+                const auto byte = static_cast<unsigned char>(*cursor++);
+                value |= std::uint64_t{ byte & 0x7Fu } << shift;
+                if ((byte & 0x80) == 0) {
+                        return true;
+                }
+        }
+        return false;
+}
+
+/* * Zigzag encoding keeps small negative deltas (a removed game) as short as small positive ones. */
+static std::uint64_t ZigzagEncode(std::int64_t value)
+{
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+static std::int64_t ZigzagDecode(std::uint64_t value)
+{
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/**
+ * @brief Calls visit(header, payload) for every record in file order, without reading any payload.
+ * * Stops at the first record that runs past the end of the file or has a bad magic, and at a last record
+ * * whose checksum fails, which is what an interrupted append leaves behind.
+ * @return The offset where the intact records end.
+ */
+template <typename Visit> static size_t ForEachRecord(const MappedFile& file, Visit&& visit)
+{
+        size_t offset = 0;
+        while (file.size() - offset >= sizeof(RecordHeader)) {
+                RecordHeader header;
+                std::memcpy(&header, file.data() + offset, sizeof(RecordHeader));
+                const size_t payload_offset = offset + sizeof(RecordHeader);
+                if (std::memcmp(header.magic, kRecordMagic, sizeof(kRecordMagic)) != 0
+                    || header.payload_size > file.size() - payload_offset) {
+                        break;
+                }
+                const std::string_view payload(file.data() + payload_offset, header.payload_size);
+                if (payload_offset + payload.size() == file.size() && Checksum(payload) != header.checksum) {
+                        break;
+                }
+                visit(header, payload);
+                offset = payload_offset + payload.size();
+        }
+        return offset;
+}
+
+/**
+ * @brief Decodes a record's payload, calling apply(app_id, delta_minutes) for each changed game.
+ * @return False, possibly after some calls, if the payload is corrupt.
+ */
+template <typename Apply> static bool DecodeDeltas(const RecordHeader& header, std::string_view payload, Apply&& apply)
+{
+        if (Checksum(payload) != header.checksum) {
+                return false;
+        }
+        const char*  cursor = payload.data();
+        const char*  end    = payload.data() + payload.size();
+        std::int64_t app_id = 0;
+        for (std::uint32_t entry = 0; entry < header.entry_count; ++entry) {
+                std::uint64_t app_id_gap = 0;
+                std::uint64_t delta      = 0;
+                if (!ReadVarint(cursor, end, app_id_gap) || !ReadVarint(cursor, end, delta)) {
+                        return false;
+                }
+                app_id += static_cast<std::int64_t>(app_id_gap);
+                apply(static_cast<int>(app_id), static_cast<int>(ZigzagDecode(delta)));
+        }
+        return cursor == end;
+}
+
+bool AppendPlaytimeSnapshot(const std::string& steam_id, const data::GameCollection& games, std::int64_t timestamp)
+{
+        std::uint64_t account = 0;
+        if (!ParseSteamId(steam_id, account)) {
+                return true;
+        }
+        const std::filesystem::path path = GetPlaytimeHistoryPath();
+
+        std::unordered_map<int, int> previous; /* * The account's playtimes as of its last snapshot */
+        bool                         has_baseline = false;
+        size_t                       intact_end   = 0;
+        size_t                       file_size    = 0;
+        {
+                MappedFile file;
+                if (file.Open(path)) {
+                        file_size  = file.size();
+                        intact_end = ForEachRecord(file, [&](const RecordHeader& header, std::string_view payload) {
+                                if (header.steam_id != account) {
+                                        return;
+                                }
+                                has_baseline = true;
+                                DecodeDeltas(header, payload, [&previous](int app_id, int delta) {
+                                        previous[app_id] += delta;
+                                });
+                        });
+                }
+        }
+        std::error_code error;
+        if (intact_end < file_size) {
+                std::filesystem::resize_file(path, intact_end, error);
+                if (error) {
+                        return false;
+                }
+        }
+
+        std::vector<PlaytimeChange> changes;
+        for (size_t index = 0; index < games.size(); ++index) {
+                const int app_id    = games.AppId(index);
+                const int playtime  = games.Playtime(index);
+                int       before    = 0;
+                auto      before_it = previous.find(app_id);
+                if (before_it != previous.end()) {
+                        before = before_it->second;
+                        previous.erase(before_it);
+                }
+                if (playtime != before) {
+                        changes.push_back({ app_id, playtime - before });
+                }
+        }
+        for (const auto& [app_id, before] : previous) {
+                if (before != 0) {
+                        changes.push_back({ app_id, -before }); /* * No longer in the library */
+                }
+        }
+        std::sort(changes.begin(), changes.end(), [](const PlaytimeChange& a, const PlaytimeChange& b) {
+                return a.app_id < b.app_id;
+        });
+
+        std::string  payload;
+        std::int64_t last_app_id = 0;
+        payload.reserve(changes.size() * 4);
+        for (const PlaytimeChange& change : changes) {
+                AppendVarint(payload, static_cast<std::uint64_t>(change.app_id - last_app_id));
+                AppendVarint(payload, ZigzagEncode(change.minutes));
+                last_app_id = change.app_id;
+        }
+
+        RecordHeader header = {};
+        std::memcpy(header.magic, kRecordMagic, sizeof(kRecordMagic));
+        header.flags        = has_baseline ? 0 : kBaselineFlag;
+        header.steam_id     = account;
+        header.timestamp    = timestamp;
+        header.entry_count  = static_cast<std::uint32_t>(changes.size());
+        header.payload_size = static_cast<std::uint32_t>(payload.size());
+        header.checksum     = Checksum(payload);
+
+        std::FILE* file = OpenFile(path, "ab");
+        if (file == nullptr) {
+                return false;
+        }
+        const bool written = std::fwrite(&header, sizeof(header), 1, file) == 1
+                             && std::fwrite(payload.data(), 1, payload.size(), file) == payload.size()
+                             && FlushFileToDisk(file);
+        return std::fclose(file) == 0 && written;
+}
+
+bool ComputePlaytimeTrend(const std::string& steam_id, std::int64_t from, std::int64_t to, PlaytimeTrend& trend)
+{
+        std::uint64_t account = 0;
+        MappedFile    file;
+        if (!ParseSteamId(steam_id, account) || !file.Open(GetPlaytimeHistoryPath())) {
+                return false;
+        }
+        trend = PlaytimeTrend();
+        std::unordered_map<int, int> gained;
+        ForEachRecord(file, [&](const RecordHeader& header, std::string_view payload) {
+                if (header.steam_id != account || header.timestamp > to) {
+                        return;
+                }
+                if (header.timestamp <= from) {
+                        trend.span_start = std::max(trend.span_start, header.timestamp);
+                        return;
+                }
+                if ((header.flags & kBaselineFlag) != 0) {
+                        trend.history_start = header.timestamp;
+                        return;
+                }
+                const bool decoded = DecodeDeltas(header, payload, [&gained](int app_id, int delta) {
+                        gained[app_id] += delta;
+                });
+                if (!decoded) {
+                        return;
+                }
+                if (trend.snapshots == 0 || header.timestamp < trend.first_time) {
+                        trend.first_time = header.timestamp;
+                }
+                trend.last_time = std::max(trend.last_time, header.timestamp);
+                ++trend.snapshots;
+        });
+
+        if (trend.span_start < 0) {
+                trend.span_start = trend.history_start; /* * Deltas then count from the baseline inside the window */
+        }
+        for (const auto& [app_id, minutes] : gained) {
+                if (minutes != 0) {
+                        trend.changes.push_back({ app_id, minutes });
+                }
+        }
+        std::sort(trend.changes.begin(), trend.changes.end(), [](const PlaytimeChange& a, const PlaytimeChange& b) {
+                return a.minutes != b.minutes ? a.minutes > b.minutes : a.app_id < b.app_id;
+        });
+        return true;
+}
+} // namespace history
+STEAM_END_NAMESPACE
@@ -0,0 +1,171 @@
+#include "steam/infix.hpp"
+
+#include <algorithm> // For std::sort, std::set_intersection, std::lower_bound
+#include <iterator>  // For std::back_inserter
+#include "steam/utility.hpp" // For ToLower
+
+STEAM_BEGIN_NAMESPACE
+namespace infix {
+
+void InfixIndex::Borrow(ArrayView<std::uint32_t> grams,
+                        ArrayView<std::uint32_t> offsets,
+                        ArrayView<std::uint32_t> postings)
+{
+        Clear();
+        borrowed_grams_    = grams;
+        borrowed_offsets_  = offsets;
+        borrowed_postings_ = postings;
+}
+
+void InfixIndex::TakeOwnership()
+{
+        if (!IsBorrowed()) {
+                return;
+        }
+        postings_.reserve(borrowed_grams_.size);
+        for (size_t i = 0; i < borrowed_grams_.size; ++i) {
+                postings_.emplace(borrowed_grams_[i],
+                                  std::vector<std::uint32_t>(borrowed_postings_.data + borrowed_offsets_[i],
+                                                             borrowed_postings_.data + borrowed_offsets_[i + 1]));
+        }
+        borrowed_grams_    = {};
+        borrowed_offsets_  = {};
+        borrowed_postings_ = {};
+}
+
+ArrayView<std::uint32_t> InfixIndex::Posting(std::uint32_t gram) const
+{
+        if (IsBorrowed()) {
+                const auto gram_it = std::lower_bound(borrowed_grams_.begin(), borrowed_grams_.end(), gram);
+                if (gram_it == borrowed_grams_.end() || *gram_it != gram) {
+                        return {};
+                }
+                const size_t i     = static_cast<size_t>(gram_it - borrowed_grams_.begin());
+                const size_t first = borrowed_offsets_[i];
+                return { borrowed_postings_.data + first, borrowed_offsets_[i + 1] - first };
+        }
+        auto posting_it = postings_.find(gram);
+        if (posting_it == postings_.end()) {
+                return {};
+        }
+        return { posting_it->second.data(), posting_it->second.size() };
+}
+
+size_t InfixIndex::Insert(std::string_view lower_name, size_t game_index)
+{
+        TakeOwnership();
+        const auto index = static_cast<std::uint32_t>(game_index);
+        size_t     added = 0;
+        for (size_t i = 0; i + kGramLength <= lower_name.size(); ++i) {
+                auto& posting = postings_[GramKey(lower_name.data() + i)];
+                /* * Loads insert in index order, so the list stays sorted by appending; repeats of a trigram
+                 * * within one name land on the same back() entry. */
+                if (posting.empty() || posting.back() < index) {
+                        posting.push_back(index);
+                        ++added;
+                } else {
+                        auto position = std::lower_bound(posting.begin(), posting.end(), index);
+                        if (*position != index) {
+                                posting.insert(position, index);
+                                ++added;
+                        }
+                }
+        }
+        return added;
+}
+
+size_t InfixIndex::Erase(std::string_view lower_name, size_t game_index)
+{
+        TakeOwnership();
+        const auto index   = static_cast<std::uint32_t>(game_index);
+        size_t     removed = 0;
+        for (size_t i = 0; i + kGramLength <= lower_name.size(); ++i) {
+                auto posting_it = postings_.find(GramKey(lower_name.data() + i));
+                if (posting_it == postings_.end()) {
+                        continue; /* * Repeated trigram, already erased. */
+                }
+                auto& posting  = posting_it->second;
+                auto  position = std::lower_bound(posting.begin(), posting.end(), index);
+                if (position != posting.end() && *position == index) {
+                        posting.erase(position);
+                        ++removed;
+                }
+                if (posting.empty()) {
+                        postings_.erase(posting_it);
+                }
+        }
+        return removed;
+}
+
+std::vector<size_t> InfixIndex::SearchContaining(const std::string& text) const
+{
+        const std::string   needle = ToLower(text);
+        std::vector<size_t> indices;
+        if (needle.empty()) {
+                return indices;
+        }
+
+        if (needle.size() < kGramLength) {
+                for (size_t i = 0; i < steam_game_collection.size(); ++i) {
+                        if (steam_game_collection.LowerName(i).find(needle) != std::string_view::npos) {
+                                indices.push_back(i);
+                        }
+                }
+        } else {
+                std::vector<ArrayView<std::uint32_t>> lists;
+                for (size_t i = 0; i + kGramLength <= needle.size(); ++i) {
+                        const ArrayView<std::uint32_t> posting = Posting(GramKey(needle.data() + i));
+                        if (posting.size == 0) {
+                                return indices; /* * Some trigram occurs in no name at all. */
+                        }
+                        lists.push_back(posting);
+                }
+                std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) {
+                        return a.size != b.size ? a.size < b.size : a.data < b.data;
+                });
+                lists.erase(std::unique(lists.begin(),
+                                        lists.end(),
+                                        [](const auto& a, const auto& b) {
+                                                return a.data == b.data;
+                                        }),
+                            lists.end());
+
+                std::vector<std::uint32_t> candidates(lists.front().begin(), lists.front().end()), scratch;
+                for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+                        scratch.clear();
+                        std::set_intersection(
+                            candidates.begin(),
+                            candidates.end(),
+                            lists[i].begin(),
+                            lists[i].end(),
+                            std::back_inserter(scratch));
+                        candidates.swap(scratch);
+                }
+                /* * Sharing every trigram does not imply adjacency ("abcxbcd" vs "abcd"), so confirm each hit. */
+                for (std::uint32_t index : candidates) {
+                        if (index < steam_game_collection.size()
+                            && steam_game_collection.LowerName(index).find(needle) != std::string_view::npos) {
+                                indices.push_back(index);
+                        }
+                }
+        }
+
+        std::sort(indices.begin(), indices.end(), [](size_t a, size_t b) {
+                const auto name_a = steam_game_collection.LowerName(a);
+                const auto name_b = steam_game_collection.LowerName(b);
+                return name_a != name_b ? name_a < name_b : a < b;
+        });
+        return indices;
+}
+
+size_t InfixIndex::MemoryUsage() const
+{
+        size_t bytes = postings_.bucket_count() * sizeof(void*);
+        for (const auto& [gram, posting] : postings_) {
+                bytes += sizeof(gram) + sizeof(posting) + 2 * sizeof(void*)
+                         + posting.capacity() * sizeof(std::uint32_t);
+        }
+        return bytes;
+}
+} // namespace infix
+STEAM_END_NAMESPACE
@@ -1,11 +1,25 @@
 #include "steam/loader.hpp"
 
-#include "steam/prefix.hpp"
+#include "steam/api_client.hpp"
+#include "steam/catalog.hpp"
+#include "steam/profile.hpp"
+#include "steam/snapshot.hpp"
 #include "steam/utility.hpp"
 
+#include "steam/graph.hpp" // For LoadRelations and the relations file paths
+
+#include <algorithm> // For std::minmax
+#include <condition_variable>
+#include <cstdlib> // For std::getenv
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <iterator> // For std::back_inserter
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 using namespace fmt;
 using json = nlohmann::json;
@@ -14,89 +28,859 @@ STEAM_BEGIN_NAMESPACE
 
 namespace loader {
 
-void SaveGamesDataToJson()
+/* * Pending output is handed to the file once it grows past this many bytes. */
+static constexpr size_t kJsonFlushThreshold = 1 << 20;
+
+/* * Appends a JSON string literal, escaped the way nlohmann::json::dump escapes it. */
+static void AppendJsonString(std::string& out, std::string_view text)
 {
-        std::filesystem::path data_file_path = GetGamesDataPath();
-        std::ofstream         ofs(data_file_path);
+        out.push_back('"');
+        for (char ch : text) {
+                switch (ch) {
+                case '"':
+                        out.append("\\\"");
+                        break;
+                case '\\':
+                        out.append("\\\\");
+                        break;
+                case '\b':
+                        out.append("\\b");
+                        break;
+                case '\f':
+                        out.append("\\f");
+                        break;
+                case '\n':
+                        out.append("\\n");
+                        break;
+                case '\r':
+                        out.append("\\r");
+                        break;
+                case '\t':
+                        out.append("\\t");
+                        break;
+                default:
+                        if (static_cast<unsigned char>(ch) < 0x20) {
+                                format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned char>(ch));
+                        } else {
+                                out.push_back(ch);
+                        }
+                }
+        }
+        out.push_back('"');
+}
 
-        if (!ofs.is_open()) {
-                print(fg(color::indian_red), "Error: Could not open {} for writing.\n", data_file_path.string());
-                return;
+bool WriteGamesJson(std::FILE*                  file,
+                    const data::GameCollection& games,
+                    const data::UserData&       user,
+                    JsonStyle                   style)
+{
+        /* * Same layout and key order as nlohmann::json's sorted objects, so PRETTY matches dump(4). */
+        const bool        pretty  = style == JsonStyle::PRETTY;
+        const char* const colon   = pretty ? ": " : ":";
+        std::string       buffer;
+        buffer.reserve(kJsonFlushThreshold + 4096);
+
+        const auto new_line = [&](size_t depth) {
+                if (pretty) {
+                        buffer.push_back('\n');
+                        buffer.append(depth * 4, ' ');
+                }
+        };
+        const auto key = [&](const char* name) {
+                buffer.append(name);
+                buffer.append(colon);
+        };
+        const auto flush = [&] {
+                const bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+                buffer.clear();
+                return written;
+        };
+
+        buffer.push_back('{');
+        new_line(1);
+        key("\"games\"");
+        buffer.push_back('[');
+        for (size_t index = 0; index < games.size(); ++index) {
+                if (index > 0) {
+                        buffer.push_back(',');
+                }
+                new_line(2);
+                buffer.push_back('{');
+                new_line(3);
+                key("\"app_id\"");
+                format_to(std::back_inserter(buffer), "{},", games.AppId(index));
+                new_line(3);
+                key("\"name\"");
+                AppendJsonString(buffer, games.Name(index));
+                buffer.push_back(',');
+                new_line(3);
+                key("\"playtime_forever\"");
+                format_to(std::back_inserter(buffer), "{}", games.Playtime(index));
+                new_line(2);
+                buffer.push_back('}');
+                if (buffer.size() >= kJsonFlushThreshold && !flush()) {
+                        return false;
+                }
         }
+        if (!games.empty()) {
+                new_line(1);
+        }
+        buffer.append("],");
+        new_line(1);
+        key("\"user\"");
+        buffer.push_back('{');
+        new_line(2);
+        key("\"location\"");
+        AppendJsonString(buffer, user.location);
+        buffer.push_back(',');
+        new_line(2);
+        key("\"steam_id\"");
+        AppendJsonString(buffer, user.steam_id);
+        buffer.push_back(',');
+        new_line(2);
+        key("\"username\"");
+        AppendJsonString(buffer, user.username);
+        new_line(1);
+        buffer.push_back('}');
+        new_line(0);
+        buffer.push_back('}');
+        return flush();
+}
+
+/* * Held by a running command and by the loader while they touch the library, and by the save worker while it
+ * * encodes it. */
+static std::mutex data_mutex;
+
+std::unique_lock<std::mutex> LockData()
+{
+        return std::unique_lock<std::mutex>(data_mutex);
+}
+
+/* * Everything one background save writes, encoded up front so the library can keep changing meanwhile. */
+struct SaveJob
+{
+        bool                     library  = false; /* * Write games.json and the snapshot files */
+        bool                     profiles = false; /* * Write the profile store */
+        data::GameCollection     games;
+        data::UserData           user;
+        JsonStyle                style = JsonStyle::PRETTY;
+        snapshot::SnapshotImages images;
+        std::string              profile_image;
+};
 
-        json json_output;
-        json_output["user"]["username"] = steam_current_user_data.username;
-        json_output["user"]["location"] = steam_current_user_data.location;
-        json_output["user"]["steam_id"] = steam_current_user_data.steam_id;
+/**
+ * @brief Encodes the dirty stores from the library and profile store as they are now, under the data lock.
+ * * Only the columns are copied for games.json, which is streamed from the copy once the lock is released.
+ */
+static SaveJob BuildSaveJob(bool library, bool profiles)
+{
+        std::lock_guard<std::mutex> lock(data_mutex);
+        SaveJob                     job;
+        job.library  = library;
+        job.profiles = profiles && !profile::steam_profile_store.profiles_.empty();
+        if (job.library) {
+                job.games.AssignColumns(steam_game_collection.Columns());
+                job.user   = steam_current_user_data;
+                job.style  = steam_games_json_style;
+                job.images = snapshot::BuildSnapshotImages();
+        }
+        if (job.profiles) {
+                job.profile_image = snapshot::BuildProfileStoreImage();
+        }
+        return job;
+}
+
+/* * Relation edits waiting to be written, coalesced per pair of AppIDs. */
+struct RelationsJob
+{
+        struct PairState
+        {
+                bool was_set = false; /* * As the journal on disk has it */
+                bool is_set  = false; /* * After the latest queued edit */
+        };
 
-        for (const auto& game : steam_game_collection) {
-                json game_json;
-                game_json["name"]             = game.name;
-                game_json["app_id"]           = game.app_id;
-                game_json["playtime_forever"] = game.playtime_forever;
-                json_output["games"].push_back(game_json);
+        /* * Edits made before file was encoded, appended ahead of it so the journal never lags the snapshot */
+        std::vector<graph::RelationRecord>       before_file;
+        std::optional<std::string>               file; /* * A compacted relations.json, written before the edits */
+        std::map<std::pair<int, int>, PairState> pairs;
+
+        bool empty() const
+        {
+                return before_file.empty() && !file && pairs.empty();
+        }
+};
+
+/* * Appends a record for every pair whose queued state differs from the journal on disk. */
+static void AppendChangedPairs(
+    const std::map<std::pair<int, int>, RelationsJob::PairState>& pairs, std::vector<graph::RelationRecord>& records)
+{
+        for (const auto& [pair, state] : pairs) {
+                if (state.is_set != state.was_set) {
+                        const auto edit = state.is_set ? graph::RelationEdit::ADD : graph::RelationEdit::REMOVE;
+                        records.push_back({ edit, pair.first, pair.second });
+                }
+        }
+}
+
+/* * What one write attempt did; gathered on the worker thread and merged into its totals afterwards. */
+struct SaveAttempt
+{
+        SaveCounts               counts;
+        std::vector<std::string> failures; /* * Messages for the main thread to print */
+};
+
+/* * Counts one write and notes a failure for the main thread; returns written. */
+static bool CountWrite(bool written, const std::filesystem::path& path, SaveAttempt& attempt)
+{
+        if (written) {
+                ++attempt.counts.written;
+        } else {
+                ++attempt.counts.failed;
+                attempt.failures.push_back(format("Could not write {}.", path.string()));
+        }
+        return written;
+}
+
+/* * Writes an image unless path already holds it; false if the write failed. */
+static bool WriteChangedImage(const std::string& image, const std::filesystem::path& path, SaveAttempt& attempt)
+{
+        if (snapshot::FileHoldsImage(path, image)) {
+                ++attempt.counts.unchanged;
+                return true;
+        }
+        return CountWrite(snapshot::WriteImage(image, path), path, attempt);
+}
+
+/* * Writes games.json and the snapshot files of a job's library; false if any of them failed. */
+static bool RunSaveJob(const SaveJob& job, SaveAttempt& attempt)
+{
+        const std::filesystem::path data_file_path = GetGamesDataPath();
+        const std::filesystem::path snapshot_path  = GetGamesSnapshotPath();
+        const std::filesystem::path index_path     = GetIndexSnapshotPath();
+        /* * games.json is an export of the games file, so it only needs rewriting when that changes. */
+        std::error_code error;
+        const bool      games_changed = !snapshot::FileHoldsSnapshot(snapshot_path, index_path, job.images.games)
+                                   || !std::filesystem::exists(data_file_path, error);
+        if (games_changed) {
+                const bool json_written = WriteFileAtomically(data_file_path, [&job](std::FILE* file) {
+                        return WriteGamesJson(file, job.games, job.user, job.style);
+                });
+                /* * A snapshot written after a failed export would hide the stale export from the retry. */
+                if (!CountWrite(json_written, data_file_path, attempt)) {
+                        return false;
+                }
+        } else {
+                ++attempt.counts.unchanged;
+        }
+        /* * After the JSON, so the snapshot is never older than the export it was written with. */
+        if (!games_changed) {
+                ++attempt.counts.unchanged;
+                return true;
+        }
+        return CountWrite(
+            snapshot::WriteSnapshotImages(job.images, snapshot_path, index_path), snapshot_path, attempt);
+}
+
+/**
+ * @brief Journals the edits a job's compacted file covers, writes the file, then its changed pairs.
+ * * Whatever was written is taken out of job, so a failure leaves exactly the unwritten part behind; the
+ * * edits are not appended when the file they apply on top of failed.
+ * @return False if anything is left.
+ */
+static bool RunRelationsJob(RelationsJob& job, SaveAttempt& attempt)
+{
+        /* * A crash between the file's rename and the journal's truncation replays the whole journal over it. */
+        if (job.file && !job.before_file.empty()) {
+                if (!CountWrite(
+                        graph::AppendRelationRecords(job.before_file), graph::GetRelationsJournalPath(), attempt)) {
+                        return false;
+                }
+                job.before_file.clear();
+        }
+        if (job.file) {
+                if (!CountWrite(graph::WriteRelationsFile(*job.file), graph::GetRelationsDataPath(), attempt)) {
+                        return false;
+                }
+                job.file.reset();
         }
-        ofs << json_output.dump(4);
-        ofs.close();
+        std::vector<graph::RelationRecord> records;
+        AppendChangedPairs(job.pairs, records);
+        if (!records.empty()) {
+                if (!CountWrite(graph::AppendRelationRecords(records), graph::GetRelationsJournalPath(), attempt)) {
+                        return false;
+                }
+        } else if (!job.pairs.empty()) {
+                ++attempt.counts.unchanged;
+        }
+        job.pairs.clear();
+        return true;
 }
 
-void LoadGamesDataFromJson()
+/**
+ * @brief One background thread that performs queued saves in order, debounced.
+ * * Changes are held until none has been queued for kSaveQuietTime, or the oldest has waited kSaveMaxDelay,
+ * * so a burst of commands costs one write per file. The library and the profile store are only flagged
+ * * dirty meanwhile and encoded once, from the state at write time; relation edits are merged per pair.
+ * * A store whose write failed stays dirty and queued, and is retried after the next debounce.
+ * * Encoding reads globals, so main flushes before returning; destruction only stops the thread.
+ */
+class SaveWorker
 {
-        if (!api_key::LoadApiKeyFromEnv() && steam_api_key.empty()) {
-                print(fg(color::yellow), "STEAM_API_KEY not found or invalid in .env file or environment.\n");
+      public:
+        ~SaveWorker()
+        {
+                {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        stopping_ = true;
+                }
+                work_ready_.notify_all();
+                if (thread_.joinable()) {
+                        thread_.join();
+                }
+        }
+
+        /* * Flags the library or the profile store dirty; it is encoded when the worker next writes. */
+        void QueueStore(Store store)
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Changed(store);
+                (store == Store::LIBRARY ? library_pending_ : profiles_pending_) = true;
+        }
+
+        void QueueRelationEdit(const graph::RelationRecord& record, bool was_set)
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Changed(Store::RELATIONS);
+                const auto key = std::minmax(record.app_id1, record.app_id2);
+                auto [it, inserted] =
+                    pending_relations_.pairs.try_emplace(std::pair<int, int>(key.first, key.second));
+                if (inserted) {
+                        it->second.was_set = was_set;
+                }
+                it->second.is_set = record.edit == graph::RelationEdit::ADD;
+        }
+
+        void QueueRelationsFile(std::string text)
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Changed(Store::RELATIONS);
+                AppendChangedPairs(pending_relations_.pairs, pending_relations_.before_file);
+                pending_relations_.file = std::move(text);
+                pending_relations_.pairs.clear();
+        }
+
+        void Flush()
+        {
+                std::unique_lock<std::mutex> lock(mutex_);
+                /* * Waits for one attempt that starts after this call; what fails in it stays queued. */
+                const std::uint64_t attempt = attempts_ + (busy_ ? 2 : 1);
+                if (HasWork() || busy_) {
+                        flush_now_ = true;
+                        work_ready_.notify_all();
+                }
+                idle_.wait(lock, [this, attempt] {
+                        return !busy_ && (!HasWork() || attempts_ >= attempt);
+                });
+                /* * Run clears it when it takes a job; otherwise the next edit would skip the debounce. */
+                flush_now_ = false;
+        }
+
+        StoreVersion Version(Store store)
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return versions_[static_cast<size_t>(store)];
+        }
+
+        SaveCounts Counts()
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return counts_;
+        }
+
+        std::vector<std::string> TakeFailures()
+        {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return std::move(failures_);
+        }
+
+      private:
+        using Clock = std::chrono::steady_clock;
+
+        bool HasWork() const
+        {
+                return library_pending_ || profiles_pending_ || !pending_relations_.empty();
+        }
+
+        /* * Marks a store dirty and (re)starts the debounce; mutex_ must be held. */
+        void Changed(Store store)
+        {
+                const auto now = Clock::now();
+                if (!HasWork()) {
+                        first_change_ = now;
+                }
+                last_change_ = now;
+                ++versions_[static_cast<size_t>(store)].changed;
+                if (!thread_.joinable()) {
+                        thread_ = std::thread(&SaveWorker::Run, this);
+                }
+                work_ready_.notify_all();
+        }
+
+        /**
+         * @brief Puts back what a failed attempt left unwritten and restarts the debounce for the retry.
+         * * Relation pairs queued since keep their latest state but take the unwritten was_set, which is
+         * * still what the disk holds. A compacted file queued since already covers every unwritten edit; they are
+         * * still journaled ahead of it, before the edits queued in between. mutex_ must be held.
+         */
+        void Requeue(const bool (&saved)[static_cast<size_t>(Store::COUNT)], RelationsJob unwritten)
+        {
+                library_pending_ |= !saved[static_cast<size_t>(Store::LIBRARY)];
+                profiles_pending_ |= !saved[static_cast<size_t>(Store::PROFILES)];
+                if (pending_relations_.file) {
+                        std::vector<graph::RelationRecord> records = std::move(unwritten.before_file);
+                        AppendChangedPairs(unwritten.pairs, records);
+                        records.insert(
+                            records.end(), pending_relations_.before_file.begin(), pending_relations_.before_file.end());
+                        pending_relations_.before_file = std::move(records);
+                } else {
+                        pending_relations_.before_file = std::move(unwritten.before_file);
+                        if (unwritten.file) {
+                                pending_relations_.file = std::move(unwritten.file);
+                        }
+                        for (const auto& [pair, state] : unwritten.pairs) {
+                                auto [it, inserted] = pending_relations_.pairs.try_emplace(pair, state);
+                                if (!inserted) {
+                                        it->second.was_set = state.was_set;
+                                }
+                        }
+                }
+                first_change_ = last_change_ = Clock::now();
+        }
+
+        void Run()
+        {
+                std::unique_lock<std::mutex> lock(mutex_);
                 while (true) {
-                        print(
-                            fg(color::gold),
-                            "Please enter your STEAM API KEY from here https://steamcommunity.com/dev/apikey (or type "
-                            "'skip' to continue without): ");
-                        std::string temp_key;
-                        if (!std::getline(std::cin, temp_key)) {
-                                print(fg(color::yellow), "\nInput error or EOF detected. Cannot read API key.\n");
-                                break;
+                        work_ready_.wait(lock, [this] {
+                                return HasWork() || stopping_;
+                        });
+                        if (!HasWork() || stopping_) {
+                                return;
                         }
-                        if (temp_key.empty()) {
-                                print(fg(color::indian_red), "No API key entered. Please try again or type 'skip'.\n");
+                        const auto due = std::min(last_change_ + kSaveQuietTime, first_change_ + kSaveMaxDelay);
+                        if (!flush_now_ && Clock::now() < due) {
+                                work_ready_.wait_until(lock, due); /* * A new change moves the deadline */
                                 continue;
                         }
-                        if (ToLower(temp_key) == "skip") {
-                                print(fg(color::yellow), "API key entry skipped. 'fetch' command will not work.\n");
-                                break;
+                        const bool   library   = library_pending_;
+                        const bool   profiles  = profiles_pending_;
+                        RelationsJob relations = std::move(pending_relations_);
+                        library_pending_       = false;
+                        profiles_pending_      = false;
+                        pending_relations_     = {};
+                        flush_now_             = false;
+                        StoreVersion versions[static_cast<size_t>(Store::COUNT)];
+                        std::copy(std::begin(versions_), std::end(versions_), std::begin(versions));
+                        busy_ = true;
+                        lock.unlock();
+                        SaveAttempt attempt;
+                        bool        saved[static_cast<size_t>(Store::COUNT)] = { true, true, true };
+                        if (library || profiles) {
+                                const SaveJob job = BuildSaveJob(library, profiles);
+                                saved[static_cast<size_t>(Store::PROFILES)] =
+                                    !job.profiles
+                                    || WriteChangedImage(job.profile_image, GetProfileStorePath(), attempt);
+                                saved[static_cast<size_t>(Store::LIBRARY)] = !job.library || RunSaveJob(job, attempt);
                         }
-                        if (api_key::isSteamAPIKeyValid(temp_key)) {
-                                steam_api_key = temp_key;
-                                std::ofstream ofs_env(".env", std::ios::app);
-                                if (ofs_env.is_open()) {
-                                        ofs_env << "STEAM_API_KEY=" << steam_api_key << "\n";
-                                        ofs_env.close();
-                                        print(fg(color::light_green), "API Key saved to .env file.\n");
-                                } else {
-                                        print(
-                                            fg(color::yellow),
-                                            "Warning: Could not open .env file to save API key.\n");
+                        saved[static_cast<size_t>(Store::RELATIONS)] = RunRelationsJob(relations, attempt);
+                        lock.lock();
+                        busy_ = false;
+                        ++attempts_;
+                        /* * Changes queued while writing, and stores that failed to write, stay dirty. */
+                        for (size_t store = 0; store < static_cast<size_t>(Store::COUNT); ++store) {
+                                if (saved[store]) {
+                                        versions_[store].saved = versions[store].changed;
                                 }
-                                break;
+                        }
+                        if (std::find(std::begin(saved), std::end(saved), false) != std::end(saved)) {
+                                Requeue(saved, std::move(relations));
+                        }
+                        counts_.written += attempt.counts.written;
+                        counts_.unchanged += attempt.counts.unchanged;
+                        counts_.failed += attempt.counts.failed;
+                        /* * A store failing on every retry is reported once per ReportSaveFailures call. */
+                        for (std::string& failure : attempt.failures) {
+                                if (std::find(failures_.begin(), failures_.end(), failure) == failures_.end()) {
+                                        failures_.push_back(std::move(failure));
+                                }
+                        }
+                        idle_.notify_all();
+                }
+        }
+
+        std::mutex               mutex_;
+        std::condition_variable  work_ready_;
+        std::condition_variable  idle_;
+        bool                     library_pending_  = false;
+        bool                     profiles_pending_ = false;
+        RelationsJob             pending_relations_;
+        Clock::time_point        first_change_;
+        Clock::time_point        last_change_;
+        StoreVersion             versions_[static_cast<size_t>(Store::COUNT)];
+        SaveCounts               counts_;
+        std::vector<std::string> failures_;      /* * Not yet reported by ReportSaveFailures */
+        std::uint64_t            attempts_  = 0; /* * Write attempts finished, for Flush */
+        bool                     busy_      = false;
+        bool                     flush_now_ = false;
+        bool                     stopping_  = false;
+        std::thread              thread_;
+};
+
+static SaveWorker save_worker;
+
+
+/* * Background loads started by StartLoadingData; default-constructed (invalid) until then. */
+static std::shared_future<void> api_key_checked;
+static std::shared_future<void> games_loaded;
+static std::shared_future<void> relations_loaded;
+
+/* * Runs a load task on its own thread; an exception is reported rather than left in the future. */
+static std::shared_future<void> RunInBackground(const char* task_name, void (*task)())
+{
+        return std::async(std::launch::async, [task_name, task] {
+                       try {
+                               task();
+                       } catch (const std::exception& e) {
+                               print(fg(color::indian_red), "Error: Loading {} failed: {}.\n", task_name, e.what());
+                       }
+               })
+            .share();
+}
+
+/* * Size and modification time of a file, so a reader can tell when a writer has replaced or appended to it. */
+struct FileStamp
+{
+        std::uintmax_t                  size = 0;
+        std::filesystem::file_time_type time;
+
+        bool operator!=(const FileStamp& other) const
+        {
+                return size != other.size || time != other.time;
+        }
+};
+
+static FileStamp StampFile(const std::filesystem::path& path)
+{
+        std::error_code error;
+        FileStamp       stamp;
+        stamp.size = std::filesystem::file_size(path, error);
+        if (error) {
+                return {};
+        }
+        stamp.time = std::filesystem::last_write_time(path, error);
+        return stamp;
+}
+
+/* * Relations file and journal as they were when a read-only process last loaded them. */
+static FileStamp loaded_relations_stamp;
+static FileStamp loaded_journal_stamp;
+
+/* * graph::LoadRelations for a read-only process, which reloads whenever a writer changes either file. */
+static void LoadSharedRelations()
+{
+        loaded_relations_stamp = StampFile(graph::GetRelationsDataPath());
+        loaded_journal_stamp   = StampFile(graph::GetRelationsJournalPath());
+        graph::LoadRelations();
+}
+
+/* * A positive whole number from the environment, or fallback when it is unset or malformed. */
+static long ReadPositiveEnv(const char* name, long fallback)
+{
+        const char* text = std::getenv(name);
+        if (text == nullptr) {
+                return fallback;
+        }
+        char*      end   = nullptr;
+        const long value = std::strtol(text, &end, 10);
+        return end != text && *end == '\0' && value > 0 ? value : fallback;
+}
+
+/* * STEAM_API_KEY as StartLoadingData read it on the main thread, for the background key check. */
+static std::string startup_env_api_key;
+
+static void CheckApiKey()
+{
+        if (!api_key::LoadApiKeyFromEnv(startup_env_api_key)) {
+                print(
+                    fg(color::yellow),
+                    "Warning: STEAM_API_KEY not found or invalid in .env file or environment; 'fetch' will ask "
+                    "for one.\n");
+        }
+}
+
+void StartLoadingData()
+{
+        /* * .env is applied and every variable read here, on the main thread, before any task starts: tasks are
+         * * handed the values they need and never call getenv or setenv themselves. */
+        dotenv::init();
+        const char* compact_json = std::getenv("STEAM_COMPACT_JSON");
+        if (compact_json != nullptr && std::string_view(compact_json) == "1") {
+                steam_games_json_style = JsonStyle::COMPACT;
+        }
+        api_client::Configure(
+            static_cast<size_t>(ReadPositiveEnv("STEAM_HTTP_POOL_SIZE", api_client::kDefaultPoolSize)),
+            std::chrono::seconds(ReadPositiveEnv("STEAM_HTTP_IDLE_SECONDS", api_client::kDefaultIdleSeconds)));
+        const char* read_only = std::getenv("STEAM_READ_ONLY");
+        steam_read_only       = read_only != nullptr && std::string_view(read_only) == "1";
+        if (steam_read_only) {
+                /* * 'fetch' is refused anyway, so a reader never waits on the network. */
+                games_loaded     = RunInBackground("the game library", LoadGamesData);
+                relations_loaded = RunInBackground("game relations", LoadSharedRelations);
+                return;
+        }
+        startup_env_api_key = api_key::ReadEnvApiKey();
+
+        api_key_checked  = RunInBackground("the API key", CheckApiKey);
+        games_loaded     = RunInBackground("the game library", LoadGamesData);
+        relations_loaded = RunInBackground("game relations", graph::LoadRelations);
+}
+
+void WaitUntilDataLoaded()
+{
+        for (const auto* loaded : { &games_loaded, &relations_loaded }) {
+                if (loaded->valid()) {
+                        loaded->wait();
+                }
+        }
+}
+
+bool IsDataLoaded()
+{
+        for (const auto* loaded : { &games_loaded, &relations_loaded }) {
+                if (loaded->valid() && loaded->wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+void WaitUntilApiKeyChecked()
+{
+        if (api_key_checked.valid()) {
+                api_key_checked.wait();
+        }
+}
+
+bool PromptForApiKey()
+{
+        print(fg(color::yellow), "STEAM_API_KEY not found or invalid in .env file or environment.\n");
+        while (true) {
+                print(
+                    fg(color::gold),
+                    "Please enter your STEAM API KEY from here https://steamcommunity.com/dev/apikey (or type "
+                    "'skip' to continue without): ");
+                std::string temp_key;
+                if (!std::getline(std::cin, temp_key)) {
+                        print(fg(color::yellow), "\nInput error or EOF detected. Cannot read API key.\n");
+                        break;
+                }
+                if (temp_key.empty()) {
+                        print(fg(color::indian_red), "No API key entered. Please try again or type 'skip'.\n");
+                        continue;
+                }
+                if (CompareIgnoreCase(temp_key, "skip") == 0) {
+                        print(fg(color::yellow), "API key entry skipped. 'fetch' command will not work.\n");
+                        break;
+                }
+                if (api_key::isSteamAPIKeyValid(temp_key)) {
+                        steam_api_key = temp_key;
+                        std::ofstream ofs_env(".env", std::ios::app);
+                        if (ofs_env.is_open()) {
+                                ofs_env << "STEAM_API_KEY=" << steam_api_key << "\n";
+                                ofs_env.close();
+                                print(fg(color::light_green), "API Key saved to .env file.\n");
                         } else {
+                                print(fg(color::yellow), "Warning: Could not open .env file to save API key.\n");
+                        }
+                        break;
+                } else {
+                        print(
+                            fg(color::indian_red),
+                            "The API key you entered is invalid. Please try again or type 'skip'.\n");
+                }
+        }
+        return !steam_api_key.empty();
+}
+
+/* * Adds the loaded library to the profile store if it was saved before the store existed. */
+static void StoreLoadedProfile()
+{
+        const std::string& steam_id = steam_current_user_data.steam_id;
+        if (steam_id.empty() || profile::steam_profile_store.profiles_.count(steam_id) > 0) {
+                return;
+        }
+        profile::steam_profile_store.StoreCurrentProfile();
+        save_worker.QueueStore(Store::PROFILES);
+}
+
+/* * Shares the published snapshot, or falls back to a private copy that is never written back. */
+static void LoadSharedGamesData()
+{
+        const std::filesystem::path snapshot_path = GetGamesSnapshotPath();
+        const std::filesystem::path index_path    = GetIndexSnapshotPath();
+        if (snapshot::ShareGamesSnapshot(snapshot_path, index_path)) {
+                steam_has_fetched_data = !steam_current_user_data.steam_id.empty();
+                if (steam_has_fetched_data) {
+                        print(
+                            fg(color::light_green),
+                            "Sharing {} games for user {} from {} (read-only).\n",
+                            steam_game_collection.size(),
+                            steam_current_user_data.username,
+                            snapshot_path.string());
+                }
+                return;
+        }
+        print(
+            fg(color::yellow),
+            "Snapshot {} cannot be shared until a writer saves it again; using a private copy (read-only).\n",
+            snapshot_path.string());
+        if (snapshot::LoadGamesSnapshot(snapshot_path, index_path, false)) {
+                steam_has_fetched_data = !steam_current_user_data.steam_id.empty();
+        } else {
+                LoadGamesDataFromJson();
+        }
+}
+
+void ReloadPublishedData()
+{
+        if (!steam_read_only) {
+                return;
+        }
+        const std::filesystem::path snapshot_path = GetGamesSnapshotPath();
+        if (snapshot::SharedSnapshotChanged(snapshot_path)
+            && snapshot::ShareGamesSnapshot(snapshot_path, GetIndexSnapshotPath())) {
+                steam_has_fetched_data = !steam_current_user_data.steam_id.empty();
+                print(
+                    fg(color::light_green),
+                    "Picked up {} games for user {} published to {}.\n",
+                    steam_game_collection.size(),
+                    steam_current_user_data.username,
+                    snapshot_path.string());
+        }
+        if (StampFile(graph::GetRelationsDataPath()) != loaded_relations_stamp
+            || StampFile(graph::GetRelationsJournalPath()) != loaded_journal_stamp) {
+                LoadSharedRelations();
+        }
+}
+
+void SaveGamesData()
+{
+        save_worker.QueueStore(Store::LIBRARY);
+        if (profile::steam_profile_store.StoreCurrentProfile()) {
+                save_worker.QueueStore(Store::PROFILES);
+        }
+}
+
+void SaveProfileStore()
+{
+        save_worker.QueueStore(Store::PROFILES);
+}
+
+void QueueRelationEdit(const graph::RelationRecord& record, bool was_set)
+{
+        save_worker.QueueRelationEdit(record, was_set);
+}
+
+void QueueRelationsFile(std::string text)
+{
+        save_worker.QueueRelationsFile(std::move(text));
+}
+
+void FlushPendingSaves()
+{
+        save_worker.Flush();
+}
+
+StoreVersion GetStoreVersion(Store store)
+{
+        return save_worker.Version(store);
+}
+
+SaveCounts GetSaveCounts()
+{
+        return save_worker.Counts();
+}
+
+void ReportSaveFailures()
+{
+        for (const std::string& failure : save_worker.TakeFailures()) {
+                print(fg(color::indian_red), "Error: {}\n", failure);
+        }
+}
+
+void LoadGamesData()
+{
+        std::lock_guard<std::mutex> data_lock(data_mutex); /* * Saves queued from here wait for the load */
+
+        std::filesystem::path snapshot_path  = GetGamesSnapshotPath();
+        std::filesystem::path index_path     = GetIndexSnapshotPath();
+        std::filesystem::path data_file_path = GetGamesDataPath();
+        std::filesystem::path profiles_path  = GetProfileStorePath();
+        std::error_code       error;
+        if (std::filesystem::exists(profiles_path, error) && !snapshot::LoadProfileStore(profiles_path)) {
+                print(fg(color::yellow), "Profile store {} is unreadable or outdated.\n", profiles_path.string());
+        }
+        if (steam_read_only) {
+                LoadSharedGamesData();
+                return;
+        }
+        const bool            has_snapshot = std::filesystem::exists(snapshot_path, error);
+        const bool            has_json     = std::filesystem::exists(data_file_path, error);
+
+        /* * A games.json edited or replaced by hand after the last save is imported instead. */
+        const bool json_is_newer =
+            has_snapshot && has_json
+            && std::filesystem::last_write_time(data_file_path, error)
+                   > std::filesystem::last_write_time(snapshot_path, error);
+
+        if (has_snapshot && !json_is_newer) {
+                if (snapshot::LoadGamesSnapshot(snapshot_path, index_path)) {
+                        steam_has_fetched_data = !steam_current_user_data.steam_id.empty();
+                        if (steam_has_fetched_data) {
                                 print(
-                                    fg(color::indian_red),
-                                    "The API key you entered is invalid. Please try again or type 'skip'.\n");
+                                    fg(color::light_green),
+                                    "Loaded {} games for user {} from {}.\n",
+                                    steam_game_collection.size(),
+                                    steam_current_user_data.username,
+                                    snapshot_path.string());
                         }
+                        StoreLoadedProfile();
+                        return;
                 }
+                print(fg(color::yellow), "Snapshot {} is unreadable or outdated.\n", snapshot_path.string());
         }
-        if (steam_api_key.empty()) {
+
+        if (has_json && LoadGamesDataFromJson() && !snapshot::SaveGamesSnapshot(snapshot_path, index_path)) {
                 print(
-                    fg(color::yellow),
-                    "Warning: API key not loaded. 'fetch' command will not work until key is set.\n");
+                    fg(color::indian_red),
+                    "Error: Could not write {} and {}.\n",
+                    snapshot_path.string(),
+                    index_path.string());
         }
+        StoreLoadedProfile();
+}
 
+bool LoadGamesDataFromJson()
+{
         std::filesystem::path data_file_path = GetGamesDataPath();
         if (!std::filesystem::exists(data_file_path)) {
-                return;
+                return false;
         }
 
         std::ifstream ifs(data_file_path);
         if (!ifs.is_open()) {
                 print(fg(color::indian_red), "Error: Could not open {} for reading.\n", data_file_path.string());
-                return;
+                return false;
         }
 
         try {
@@ -114,20 +898,16 @@ void LoadGamesDataFromJson()
                 }
 
                 if (json_input.contains("games")) {
-                        steam_game_collection.clear();
-                        prefix::steam_game_name_prefix_tree.Clear();
-                        prefix::steam_game_name_to_index_map.clear();
-                        size_t current_index = 0;
+                        data::GameCollection imported_games;
+                        imported_games.reserve(json_input["games"].size());
                         for (const auto& game_json : json_input["games"]) {
                                 data::GameData game;
                                 game.name             = game_json.value("name", "Unknown Game");
                                 game.app_id           = game_json.value("app_id", 0);
                                 game.playtime_forever = game_json.value("playtime_forever", 0);
-                                steam_game_collection.push_back(game);
-                                prefix::steam_game_name_prefix_tree.Insert(game.name, current_index);
-                                prefix::steam_game_name_to_index_map[ToLower(game.name)] = current_index;
-                                current_index++;
+                                imported_games.push_back(game);
                         }
+                        catalog::LoadColumns(imported_games.Columns());
                 }
                 if (steam_has_fetched_data) {
                         print(
@@ -137,6 +917,7 @@ void LoadGamesDataFromJson()
                             steam_current_user_data.username,
                             data_file_path.string());
                 }
+                return true;
 
         } catch (const json::exception& e) {
                 print(fg(color::indian_red), "Error parsing JSON from {}: {}.\n", data_file_path.string(), e.what());
@@ -144,6 +925,7 @@ void LoadGamesDataFromJson()
                         ifs.close();
                 }
         }
+        return false;
 }
 
 } // namespace loader
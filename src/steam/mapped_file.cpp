@@ -0,0 +1,96 @@
+#include "steam/mapped_file.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>    // For open
+#include <sys/mman.h> // For mmap, munmap
+#include <sys/stat.h> // For fstat
+#include <unistd.h>   // For close
+#endif
+
+STEAM_BEGIN_NAMESPACE
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+        Close();
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+                return false;
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+                CloseHandle(file);
+                return false;
+        }
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+                CloseHandle(file);
+                return false;
+        }
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr) {
+                CloseHandle(mapping);
+                CloseHandle(file);
+                return false;
+        }
+        file_handle_    = file;
+        mapping_handle_ = mapping;
+        data_           = static_cast<const char*>(view);
+        size_           = static_cast<size_t>(file_size.QuadPart);
+        return true;
+}
+
+void MappedFile::Close()
+{
+        if (data_ != nullptr) {
+                UnmapViewOfFile(data_);
+        }
+        if (mapping_handle_ != nullptr) {
+                CloseHandle(static_cast<HANDLE>(mapping_handle_));
+        }
+        if (file_handle_ != nullptr) {
+                CloseHandle(static_cast<HANDLE>(file_handle_));
+        }
+        data_           = nullptr;
+        size_           = 0;
+        file_handle_    = nullptr;
+        mapping_handle_ = nullptr;
+}
+#else
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+        Close();
+        const int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0) {
+                return false;
+        }
+        struct stat file_status;
+        if (::fstat(file, &file_status) != 0 || file_status.st_size <= 0) {
+                ::close(file);
+                return false;
+        }
+        const auto file_size = static_cast<size_t>(file_status.st_size);
+        void*      view      = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file, 0);
+        /* * The mapping keeps the file alive; the descriptor is no longer needed. */
+        ::close(file);
+        if (view == MAP_FAILED) {
+                return false;
+        }
+        data_ = static_cast<const char*>(view);
+        size_ = file_size;
+        return true;
+}
+
+void MappedFile::Close()
+{
+        if (data_ != nullptr) {
+                ::munmap(const_cast<char*>(data_), size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+}
+#endif
+STEAM_END_NAMESPACE
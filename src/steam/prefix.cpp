@@ -1,52 +1,821 @@
 #include "steam/prefix.hpp"
 
+#include <future> // For std::async in InsertAll
+
 STEAM_BEGIN_NAMESPACE
 namespace prefix {
 
+/* * Playtime ranking shared by the top caches and TopByPrefix: most played first, then name, then index. */
+static bool RanksHigherByPlaytime(size_t game_a, size_t game_b)
+{
+        const int playtime_a = steam_game_collection.Playtime(game_a);
+        const int playtime_b = steam_game_collection.Playtime(game_b);
+        if (playtime_a != playtime_b) {
+                return playtime_a > playtime_b;
+        }
+        const std::string_view name_a = steam_game_collection.LowerName(game_a);
+        const std::string_view name_b = steam_game_collection.LowerName(game_b);
+        if (name_a != name_b) {
+                return name_a < name_b;
+        }
+        return game_a < game_b;
+}
+
+/* * Plain Levenshtein distance over the word characters of two strings, so "portal2" and "portal 2" are equal. */
+static std::uint32_t
+WordCharacterEditDistance(std::string_view a, std::string_view b, std::vector<std::uint16_t>& scratch)
+{
+        scratch.assign(b.size() + 1, 0);
+        std::uint16_t b_length = 0;
+        for (char ch : b) {
+                if (IsWordCharacter(ch)) {
+                        ++b_length;
+                        scratch[b_length] = b_length;
+                }
+        }
+        for (char a_ch : a) {
+                if (!IsWordCharacter(a_ch)) {
+                        continue;
+                }
+                std::uint16_t diagonal = scratch[0];
+                ++scratch[0];
+                std::uint16_t column = 0;
+                for (char b_ch : b) {
+                        if (!IsWordCharacter(b_ch)) {
+                                continue;
+                        }
+                        ++column;
+                        const std::uint16_t above        = scratch[column];
+                        const auto          substitution = static_cast<std::uint16_t>(diagonal + (a_ch != b_ch));
+                        scratch[column]                  = std::min({ static_cast<std::uint16_t>(above + 1),
+                                                     static_cast<std::uint16_t>(scratch[column - 1] + 1),
+                                                     substitution });
+                        diagonal                         = above;
+                }
+        }
+        return scratch[b_length];
+}
+
+struct PrefixTree::FuzzyState
+{
+        std::string                query; /* * Lowercase query */
+        std::uint32_t              max_distance;
+        size_t                     row_width; /* * query.size() + 1 */
+        std::vector<std::uint16_t> rows;      /* * DP row at the end of each node on the current path */
+        std::vector<std::uint16_t> best;      /* * Closest fragment seen so far on the path, per node level */
+        std::vector<size_t>        reach;     /* * One past the last cell of that row below max_distance + 1 */
+        std::vector<FuzzyMatch>    matches;
+};
+
+std::uint32_t PrefixTree::FindChild(std::uint32_t node_index, char ch, std::uint32_t* previous_sibling) const
+{
+        const auto    key      = static_cast<unsigned char>(ch);
+        std::uint32_t previous = kNone;
+        for (std::uint32_t child = nodes_[node_index].first_child; child != kNone; child = nodes_[child].next_sibling) {
+                const auto first = static_cast<unsigned char>(label_arena_[nodes_[child].label_offset]);
+                if (first == key) {
+                        return child;
+                }
+                if (first > key) {
+                        break;
+                }
+                previous = child;
+        }
+        if (previous_sibling) {
+                *previous_sibling = previous;
+        }
+        return kNone;
+}
+
+void PrefixTree::SplitNode(std::uint32_t node_index, std::uint32_t split_at)
+{
+        Node tail;
+        tail.label_offset = nodes_[node_index].label_offset + split_at;
+        tail.label_length = nodes_[node_index].label_length - split_at;
+        tail.first_child  = nodes_[node_index].first_child;
+        tail.first_value  = nodes_[node_index].first_value;
+        tail.subtree_size = nodes_[node_index].subtree_size;
+
+        /* * Both halves cover the same games, so the tail gets its own copy of the head's cache. */
+        if (nodes_[node_index].top_slot != kNone) {
+                tail.top_slot = AllocateTopSlot();
+                std::copy_n(top_by_playtime_.begin() + size_t{ nodes_[node_index].top_slot } * kTopCacheSize,
+                            kTopCacheSize,
+                            top_by_playtime_.begin() + size_t{ tail.top_slot } * kTopCacheSize);
+        }
+
+        const std::uint32_t tail_index = AllocateNode(tail); /* ! May reallocate, so index nodes_ again below. */
+
+        Node& head        = nodes_[node_index];
+        head.label_length = split_at;
+        head.first_child  = tail_index;
+        head.first_value  = kNone;
+}
+
+void PrefixTree::AddToTopCache(std::uint32_t node_index, std::uint32_t game_index)
+{
+        Node& node = nodes_[node_index];
+        ++node.subtree_size;
+
+        if (node.top_slot == kNone) {
+                if (node.subtree_size <= kTopCacheSize) {
+                        return; /* * Small subtrees are cheaper to collect than to cache. */
+                }
+                /* * Just outgrew the threshold: rank the kTopCacheSize games already stored plus the new one. */
+                std::vector<size_t> candidates;
+                CollectGameIndicesRecursive(node_index, candidates);
+                candidates.push_back(game_index);
+                std::sort(candidates.begin(), candidates.end(), RanksHigherByPlaytime);
+
+                const std::uint32_t slot    = AllocateTopSlot();
+                nodes_[node_index].top_slot = slot;
+                std::copy_n(
+                    candidates.begin(), kTopCacheSize, top_by_playtime_.begin() + size_t{ slot } * kTopCacheSize);
+                return;
+        }
+
+        /* * Insertion step of an insertion sort over a full, best-first cache. */
+        std::uint32_t* cache = top_by_playtime_.data() + size_t{ node.top_slot } * kTopCacheSize;
+        if (!RanksHigherByPlaytime(game_index, cache[kTopCacheSize - 1])) {
+                return;
+        }
+        std::uint32_t position = kTopCacheSize - 1;
+        while (position > 0 && RanksHigherByPlaytime(game_index, cache[position - 1])) {
+                cache[position] = cache[position - 1];
+                --position;
+        }
+        cache[position] = game_index;
+}
 
 void PrefixTree::Insert(const std::string& name, size_t game_index)
 {
-        Node*       current_node = root_node_;
-        std::string lower_name   = ToLower(name);
-        for (char ch : lower_name) {
-                if (current_node->children.find(ch) == current_node->children.end()) {
-                        current_node->children[ch] = new Node();
+        const std::string lower_name = ToLower(name);
+        const auto        game       = static_cast<std::uint32_t>(game_index);
+        std::uint32_t     node_index = 0;
+        size_t            position   = 0;
+
+        AddToTopCache(node_index, game);
+
+        while (position < lower_name.size()) {
+                std::uint32_t previous_sibling = kNone;
+                std::uint32_t child            = FindChild(node_index, lower_name[position], &previous_sibling);
+
+                if (child == kNone) {
+                        /* * No edge starts with this character: hang the whole remaining suffix off one new leaf. */
+                        Node leaf;
+                        leaf.label_offset = static_cast<std::uint32_t>(label_arena_.size());
+                        leaf.label_length = static_cast<std::uint32_t>(lower_name.size() - position);
+                        label_arena_.append(lower_name.data() + position, lower_name.size() - position);
+
+                        if (previous_sibling == kNone) {
+                                leaf.next_sibling = nodes_[node_index].first_child;
+                        } else {
+                                leaf.next_sibling = nodes_[previous_sibling].next_sibling;
+                        }
+                        child = AllocateNode(leaf);
+                        if (previous_sibling == kNone) {
+                                nodes_[node_index].first_child = child;
+                        } else {
+                                nodes_[previous_sibling].next_sibling = child;
+                        }
+                        AddToTopCache(child, game);
+                        node_index = child;
+                        break;
+                }
+
+                /* * Follow the edge as far as it agrees with the name, splitting it where they diverge. */
+                const Node&   edge    = nodes_[child];
+                std::uint32_t matched = 1;
+                while (matched < edge.label_length && position + matched < lower_name.size()
+                       && label_arena_[edge.label_offset + matched] == lower_name[position + matched]) {
+                        ++matched;
                 }
-                current_node = current_node->children[ch];
+                if (matched < edge.label_length) {
+                        SplitNode(child, matched);
+                }
+                AddToTopCache(child, game);
+                node_index = child;
+                position += matched;
+        }
+
+        std::uint32_t entry;
+        if (free_values_.empty()) {
+                entry = static_cast<std::uint32_t>(value_entries_.size());
+                value_entries_.emplace_back();
+        } else {
+                entry = free_values_.back();
+                free_values_.pop_back();
         }
-        current_node->game_indices.push_back(game_index);
+        value_entries_[entry]          = { game, nodes_[node_index].first_value };
+        nodes_[node_index].first_value = entry;
 }
 
-std::vector<size_t> PrefixTree::SearchByPrefix(const std::string& prefix) const
+void PrefixTree::InsertAll(size_t game_count, unsigned thread_count)
+{
+        Clear();
+        if (thread_count <= 1) {
+                for (size_t index = 0; index < game_count; ++index) {
+                        Insert(std::string(steam_game_collection.Name(index)), index);
+                }
+                return;
+        }
+
+        /* * Cut the first-byte range into contiguous pieces of about equal game counts; empty names go first. */
+        std::vector<size_t> first_byte_counts(257, 0);
+        for (size_t index = 0; index < game_count; ++index) {
+                const std::string_view lower_name = steam_game_collection.LowerName(index);
+                ++first_byte_counts[lower_name.empty() ? 0 : size_t{ static_cast<unsigned char>(lower_name[0]) } + 1];
+        }
+        std::vector<unsigned> partition_of(257, 0);
+        unsigned              partition = 0;
+        size_t                assigned  = 0;
+        for (size_t bucket = 0; bucket < first_byte_counts.size(); ++bucket) {
+                if (assigned >= game_count * (partition + 1) / thread_count && partition + 1 < thread_count) {
+                        ++partition;
+                }
+                partition_of[bucket] = partition;
+                assigned += first_byte_counts[bucket];
+        }
+
+        std::vector<std::vector<std::uint32_t>> partition_games(partition + 1);
+        for (size_t index = 0; index < game_count; ++index) {
+                const std::string_view lower_name = steam_game_collection.LowerName(index);
+                const size_t bucket = lower_name.empty() ? 0 : size_t{ static_cast<unsigned char>(lower_name[0]) } + 1;
+                partition_games[partition_of[bucket]].push_back(static_cast<std::uint32_t>(index));
+        }
+
+        /* * Each piece is an ordinary tree over its own games, built in index order like a serial build. */
+        std::vector<PrefixTree> parts(partition_games.size());
+        const auto              build_part = [&](size_t part) {
+                for (std::uint32_t index : partition_games[part]) {
+                        parts[part].Insert(std::string(steam_game_collection.Name(index)), index);
+                }
+        };
+        std::vector<std::future<void>> builds;
+        for (size_t part = 1; part < parts.size(); ++part) {
+                builds.push_back(std::async(std::launch::async, build_part, part));
+        }
+        build_part(0);
+        for (auto& build : builds) {
+                build.get();
+        }
+        MergePartitions(parts);
+}
+
+void PrefixTree::MergePartitions(const std::vector<PrefixTree>& parts)
+{
+        size_t node_total  = 1;
+        size_t value_total = 0;
+        size_t label_total = 0;
+        size_t slot_total  = 0;
+        for (const PrefixTree& part : parts) {
+                node_total += part.nodes_.size() - 1;
+                value_total += part.value_entries_.size();
+                label_total += part.label_arena_.size();
+                slot_total += part.top_by_playtime_.size();
+        }
+        nodes_.reserve(node_total);
+        value_entries_.reserve(value_total);
+        label_arena_.reserve(label_total);
+        top_by_playtime_.reserve(slot_total + kTopCacheSize);
+
+        /* * A part's root becomes this root; its other nodes are appended with every link shifted. */
+        std::uint32_t       last_child = kNone;
+        std::vector<size_t> root_candidates;
+        for (const PrefixTree& part : parts) {
+                const auto node_base  = static_cast<std::uint32_t>(nodes_.size() - 1);
+                const auto value_base = static_cast<std::uint32_t>(value_entries_.size());
+                const auto label_base = static_cast<std::uint32_t>(label_arena_.size());
+                const auto slot_base  = static_cast<std::uint32_t>(top_by_playtime_.size() / kTopCacheSize);
+                const auto node_link  = [node_base](std::uint32_t link) {
+                        return link == kNone ? kNone : link + node_base;
+                };
+                const auto value_link = [value_base](std::uint32_t link) {
+                        return link == kNone ? kNone : link + value_base;
+                };
+
+                for (size_t node_index = 1; node_index < part.nodes_.size(); ++node_index) {
+                        Node node = part.nodes_[node_index];
+                        node.label_offset += label_base;
+                        node.first_child  = node_link(node.first_child);
+                        node.next_sibling = node_link(node.next_sibling);
+                        node.first_value  = value_link(node.first_value);
+                        node.top_slot     = node.top_slot == kNone ? kNone : node.top_slot + slot_base;
+                        nodes_.push_back(node);
+                }
+                for (const ValueEntry& entry : part.value_entries_) {
+                        value_entries_.push_back({ entry.game_index, value_link(entry.next) });
+                }
+                label_arena_.append(part.label_arena_.data(), part.label_arena_.size());
+                top_by_playtime_.append(part.top_by_playtime_.data(), part.top_by_playtime_.size());
+                for (std::uint32_t node_index : part.free_nodes_) {
+                        free_nodes_.push_back(node_link(node_index));
+                }
+                for (std::uint32_t entry : part.free_values_) {
+                        free_values_.push_back(value_link(entry));
+                }
+                for (std::uint32_t slot : part.free_top_slots_) {
+                        free_top_slots_.push_back(slot + slot_base);
+                }
+
+                /* * Parts cover ascending first-byte ranges, so appending their children keeps siblings sorted. */
+                const Node& part_root = part.nodes_[0];
+                if (part_root.first_child != kNone) {
+                        if (last_child == kNone) {
+                                nodes_[0].first_child = node_link(part_root.first_child);
+                        } else {
+                                nodes_[last_child].next_sibling = node_link(part_root.first_child);
+                        }
+                        last_child = node_link(part_root.first_child);
+                        while (nodes_[last_child].next_sibling != kNone) {
+                                last_child = nodes_[last_child].next_sibling;
+                        }
+                }
+                if (part_root.first_value != kNone) {
+                        nodes_[0].first_value = value_link(part_root.first_value); /* * Empty names: first part only */
+                }
+                nodes_[0].subtree_size += part_root.subtree_size;
+                if (part_root.top_slot != kNone) {
+                        const auto cache = part.top_by_playtime_.begin() + size_t{ part_root.top_slot } * kTopCacheSize;
+                        root_candidates.insert(root_candidates.end(), cache, cache + kTopCacheSize);
+                        free_top_slots_.push_back(part_root.top_slot + slot_base);
+                } else {
+                        part.CollectGameIndicesRecursive(0, root_candidates);
+                }
+        }
+
+        /* * The root ranks the union of the parts' top games, which holds the overall top kTopCacheSize. */
+        if (nodes_[0].subtree_size > kTopCacheSize) {
+                std::partial_sort(root_candidates.begin(),
+                                  root_candidates.begin() + kTopCacheSize,
+                                  root_candidates.end(),
+                                  RanksHigherByPlaytime);
+                const std::uint32_t slot = AllocateTopSlot();
+                nodes_[0].top_slot       = slot;
+                std::copy_n(
+                    root_candidates.begin(), kTopCacheSize, top_by_playtime_.begin() + size_t{ slot } * kTopCacheSize);
+        }
+}
+
+bool PrefixTree::FindNamePath(const std::string& lower_name, std::vector<std::uint32_t>& path) const
+{
+        size_t position = 0;
+        path.assign(1, 0);
+        while (position < lower_name.size()) {
+                const std::uint32_t child = FindChild(path.back(), lower_name[position]);
+                if (child == kNone) {
+                        return false;
+                }
+                const Node&            edge  = nodes_[child];
+                const std::string_view label = { label_arena_.data() + edge.label_offset, edge.label_length };
+                if (lower_name.compare(position, edge.label_length, label) != 0) {
+                        return false;
+                }
+                path.push_back(child);
+                position += edge.label_length;
+        }
+        return true;
+}
+
+bool PrefixTree::Erase(const std::string& name, size_t game_index)
+{
+        const auto                 game = static_cast<std::uint32_t>(game_index);
+        std::vector<std::uint32_t> path;
+        if (!FindNamePath(ToLower(name), path)) {
+                return false;
+        }
+
+        std::uint32_t* link = &nodes_[path.back()].first_value;
+        while (*link != kNone && value_entries_[*link].game_index != game) {
+                link = &value_entries_[*link].next;
+        }
+        if (*link == kNone) {
+                return false;
+        }
+        const std::uint32_t entry = *link;
+        *link                     = value_entries_[entry].next;
+        /* * A freed entry is saved with the rest, and a reader rejects an index whose entries name a game past
+         * * the end, as the removed game's old index may be once the library shrinks. */
+        value_entries_[entry] = { 0, kNone };
+        free_values_.push_back(entry);
+
+        /* * Deepest first, so a refilled cache reads child caches that no longer hold the game. */
+        for (auto node_it = path.rbegin(); node_it != path.rend(); ++node_it) {
+                RemoveFromTopCache(*node_it, game);
+        }
+
+        /* * Restore the radix invariant bottom-up: every non-root node either stores games or branches. */
+        for (size_t depth = path.size() - 1; depth > 0; --depth) {
+                const std::uint32_t node_index = path[depth];
+                const Node&         node       = nodes_[node_index];
+                if (node.first_value != kNone) {
+                        break;
+                }
+                if (node.first_child == kNone) {
+                        const std::uint32_t parent_index = path[depth - 1];
+                        std::uint32_t*      sibling_link = &nodes_[parent_index].first_child;
+                        while (*sibling_link != node_index) {
+                                sibling_link = &nodes_[*sibling_link].next_sibling;
+                        }
+                        *sibling_link = node.next_sibling;
+                        if (node.top_slot != kNone) {
+                                free_top_slots_.push_back(node.top_slot);
+                        }
+                        dead_label_bytes_ += node.label_length;
+                        nodes_[node_index] = Node();
+                        free_nodes_.push_back(node_index);
+                        continue; /* * The parent may now be a lone-child chain itself. */
+                }
+                if (nodes_[node.first_child].next_sibling == kNone) {
+                        MergeWithOnlyChild(node_index);
+                }
+                break;
+        }
+        if (dead_label_bytes_ >= kMinLabelCompaction && dead_label_bytes_ * 2 > label_arena_.size()) {
+                CompactLabels();
+        }
+        return true;
+}
+
+bool PrefixTree::UpdatePlaytime(const std::string& name, size_t game_index, int previous_playtime)
+{
+        const auto                 game = static_cast<std::uint32_t>(game_index);
+        std::vector<std::uint32_t> path;
+        if (!FindNamePath(ToLower(name), path)) {
+                return false;
+        }
+        std::uint32_t value = nodes_[path.back()].first_value;
+        while (value != kNone && value_entries_[value].game_index != game) {
+                value = value_entries_[value].next;
+        }
+        if (value == kNone) {
+                return false;
+        }
+
+        const bool increased = steam_game_collection.Playtime(game_index) > previous_playtime;
+        /* * Deepest first, so a refilled cache reads child caches that already rank the new playtime. */
+        for (auto node_it = path.rbegin(); node_it != path.rend(); ++node_it) {
+                if (nodes_[*node_it].top_slot == kNone) {
+                        continue;
+                }
+                std::uint32_t* cache    = top_by_playtime_.data() + size_t{ nodes_[*node_it].top_slot } * kTopCacheSize;
+                std::uint32_t  position = 0;
+                while (position < kTopCacheSize && cache[position] != game) {
+                        ++position;
+                }
+                if (position == kTopCacheSize) {
+                        /* * Not cached: only a gain can lift it past the last entry, as in AddToTopCache. */
+                        if (!increased || !RanksHigherByPlaytime(game, cache[kTopCacheSize - 1])) {
+                                continue;
+                        }
+                        position = kTopCacheSize - 1;
+                } else if (!increased) {
+                        while (position + 1 < kTopCacheSize && RanksHigherByPlaytime(cache[position + 1], game)) {
+                                cache[position] = cache[position + 1];
+                                ++position;
+                        }
+                        cache[position] = game;
+                        /* * Above the last slot it still outranks every uncached game; in it, one may now lead. */
+                        if (position == kTopCacheSize - 1) {
+                                RefillTopCache(*node_it);
+                        }
+                        continue;
+                }
+                while (position > 0 && RanksHigherByPlaytime(game, cache[position - 1])) {
+                        cache[position] = cache[position - 1];
+                        --position;
+                }
+                cache[position] = game;
+        }
+        return true;
+}
+
+void PrefixTree::CompactLabels()
+{
+        /* * Pre-order, so a node's label is followed by its first child's and MergeWithOnlyChild copies less. */
+        std::vector<char>          labels;
+        std::vector<std::uint32_t> pending{ 0 };
+        labels.reserve(label_arena_.size() - dead_label_bytes_);
+        while (!pending.empty()) {
+                const std::uint32_t node_index = pending.back();
+                pending.pop_back();
+                Node&      node   = nodes_[node_index];
+                const auto offset = static_cast<std::uint32_t>(labels.size());
+                labels.insert(labels.end(),
+                              label_arena_.begin() + node.label_offset,
+                              label_arena_.begin() + node.label_offset + node.label_length);
+                node.label_offset = offset;
+                /* * Pushed in reverse so the first child is popped, and stored, next. */
+                const size_t first_pushed = pending.size();
+                for (std::uint32_t child = node.first_child; child != kNone; child = nodes_[child].next_sibling) {
+                        pending.push_back(child);
+                }
+                std::reverse(pending.begin() + first_pushed, pending.end());
+        }
+        label_arena_.assign(labels.data(), labels.data() + labels.size());
+        dead_label_bytes_ = 0;
+}
+
+std::uint32_t PrefixTree::AllocateNode(const Node& node)
+{
+        if (free_nodes_.empty()) {
+                nodes_.push_back(node);
+                return static_cast<std::uint32_t>(nodes_.size() - 1);
+        }
+        const std::uint32_t node_index = free_nodes_.back();
+        free_nodes_.pop_back();
+        nodes_[node_index] = node;
+        return node_index;
+}
+
+std::uint32_t PrefixTree::AllocateTopSlot()
+{
+        if (free_top_slots_.empty()) {
+                top_by_playtime_.resize(top_by_playtime_.size() + kTopCacheSize);
+                return static_cast<std::uint32_t>(top_by_playtime_.size() / kTopCacheSize - 1);
+        }
+        const std::uint32_t slot = free_top_slots_.back();
+        free_top_slots_.pop_back();
+        return slot;
+}
+
+void PrefixTree::RemoveFromTopCache(std::uint32_t node_index, std::uint32_t game_index)
 {
-        Node*       current_node = root_node_;
-        std::string lower_prefix = ToLower(prefix);
-        for (char ch : lower_prefix) {
-                if (current_node->children.find(ch) == current_node->children.end()) {
-                        return {};
+        Node& node = nodes_[node_index];
+        --node.subtree_size;
+        if (node.top_slot == kNone) {
+                return;
+        }
+        if (node.subtree_size <= kTopCacheSize) {
+                /* * Back under the threshold: small subtrees are collected on demand again. */
+                free_top_slots_.push_back(node.top_slot);
+                node.top_slot = kNone;
+                return;
+        }
+
+        const std::uint32_t* cache = top_by_playtime_.begin() + size_t{ node.top_slot } * kTopCacheSize;
+        if (std::find(cache, cache + kTopCacheSize, game_index) != cache + kTopCacheSize) {
+                RefillTopCache(node_index);
+        }
+}
+
+void PrefixTree::RefillTopCache(std::uint32_t node_index)
+{
+        /* * Every game of the subtree that can rank in the top kTopCacheSize is either stored on this node, in a
+         * * small child subtree, or in a child's cache, so the subtree itself is never walked. */
+        std::vector<size_t> candidates;
+        for (std::uint32_t value = nodes_[node_index].first_value; value != kNone; value = value_entries_[value].next) {
+                candidates.push_back(value_entries_[value].game_index);
+        }
+        for (std::uint32_t child = nodes_[node_index].first_child; child != kNone; child = nodes_[child].next_sibling) {
+                if (nodes_[child].top_slot == kNone) {
+                        CollectGameIndicesRecursive(child, candidates);
+                } else {
+                        const auto cache = top_by_playtime_.begin() + size_t{ nodes_[child].top_slot } * kTopCacheSize;
+                        candidates.insert(candidates.end(), cache, cache + kTopCacheSize);
                 }
-                current_node = current_node->children[ch];
+        }
+        std::partial_sort(
+            candidates.begin(), candidates.begin() + kTopCacheSize, candidates.end(), RanksHigherByPlaytime);
+        std::copy_n(candidates.begin(),
+                    kTopCacheSize,
+                    top_by_playtime_.begin() + size_t{ nodes_[node_index].top_slot } * kTopCacheSize);
+}
+
+void PrefixTree::MergeWithOnlyChild(std::uint32_t node_index)
+{
+        const std::uint32_t child_index = nodes_[node_index].first_child;
+        const Node          child       = nodes_[child_index];
+        Node&               node        = nodes_[node_index];
+
+        /* * Labels created by one insertion or split are adjacent in the arena; otherwise copy both to the end. */
+        if (node.label_offset + node.label_length != child.label_offset) {
+                std::string label(label_arena_.data() + node.label_offset, node.label_length);
+                label.append(label_arena_.data() + child.label_offset, child.label_length);
+                node.label_offset = static_cast<std::uint32_t>(label_arena_.size());
+                label_arena_.append(label.data(), label.size());
+                dead_label_bytes_ += label.size(); /* * Both old labels */
+        }
+        node.label_length += child.label_length;
+        node.first_child = child.first_child;
+        node.first_value = child.first_value;
+
+        /* * Both nodes cover the same games; the node's cache was kept current on the erase path. */
+        if (child.top_slot != kNone) {
+                free_top_slots_.push_back(child.top_slot);
+        }
+        nodes_[child_index] = Node();
+        free_nodes_.push_back(child_index);
+}
+
+std::uint32_t PrefixTree::FindPrefixNode(const std::string& lower_prefix) const
+{
+        std::uint32_t node_index = 0;
+        size_t        position   = 0;
+
+        while (position < lower_prefix.size()) {
+                const std::uint32_t child = FindChild(node_index, lower_prefix[position]);
+                if (child == kNone) {
+                        return kNone;
+                }
+                /* * The prefix may end part-way along an edge; everything below that edge still matches. */
+                const Node& edge = nodes_[child];
+                for (std::uint32_t i = 1; i < edge.label_length && position + i < lower_prefix.size(); ++i) {
+                        if (label_arena_[edge.label_offset + i] != lower_prefix[position + i]) {
+                                return kNone;
+                        }
+                }
+                node_index = child;
+                position += edge.label_length;
+        }
+        return node_index;
+}
+
+std::vector<size_t> PrefixTree::SearchByPrefix(const std::string& prefix) const
+{
+        const std::uint32_t node_index = FindPrefixNode(ToLower(prefix));
+        if (node_index == kNone) {
+                return {};
         }
 
         std::vector<size_t> result_indices;
-        CollectGameIndicesRecursive(current_node, result_indices);
+        CollectGameIndicesRecursive(node_index, result_indices);
         std::sort(result_indices.begin(), result_indices.end());
         return result_indices;
 }
 
-void PrefixTree::CollectGameIndicesRecursive(const Node* current_node, std::vector<size_t>& indices) const
+std::vector<size_t> PrefixTree::TopByPrefix(const std::string& prefix, size_t count, SearchRank rank) const
 {
-        if (!current_node) {
+        std::vector<size_t> result_indices;
+        const std::uint32_t node_index = FindPrefixNode(ToLower(prefix));
+        if (node_index == kNone || count == 0) {
+                return result_indices;
+        }
+        const Node& node = nodes_[node_index];
+        result_indices.reserve(std::min<size_t>(count, node.subtree_size));
+
+        if (rank == SearchRank::NAME) {
+                /* * Children are sorted, so a pre-order walk already yields name order. */
+                CollectInNameOrder(node_index, count, result_indices);
+                return result_indices;
+        }
+
+        if (node.top_slot != kNone && count <= kTopCacheSize) {
+                const auto cache = top_by_playtime_.begin() + size_t{ node.top_slot } * kTopCacheSize;
+                result_indices.assign(cache, cache + count);
+                return result_indices;
+        }
+
+        /* * Small subtree (at most kTopCacheSize games) or a request larger than the cache. */
+        CollectGameIndicesRecursive(node_index, result_indices);
+        const size_t keep = std::min(count, result_indices.size());
+        std::partial_sort(
+            result_indices.begin(), result_indices.begin() + keep, result_indices.end(), RanksHigherByPlaytime);
+        result_indices.resize(keep);
+        return result_indices;
+}
+
+void PrefixTree::CollectInNameOrder(std::uint32_t node_index, size_t count, std::vector<size_t>& indices) const
+{
+        /* * Games stored on the same node share one lowercase name; order them by index. */
+        const size_t first_new = indices.size();
+        for (std::uint32_t value = nodes_[node_index].first_value; value != kNone; value = value_entries_[value].next) {
+                indices.push_back(value_entries_[value].game_index);
+        }
+        std::sort(indices.begin() + first_new, indices.end());
+        if (indices.size() >= count) {
+                indices.resize(count);
                 return;
         }
+        for (std::uint32_t child = nodes_[node_index].first_child; child != kNone; child = nodes_[child].next_sibling) {
+                CollectInNameOrder(child, count, indices);
+                if (indices.size() >= count) {
+                        return;
+                }
+        }
+}
+
+void PrefixTree::CollectGameIndicesRecursive(std::uint32_t node_index, std::vector<size_t>& indices) const
+{
+        for (std::uint32_t value = nodes_[node_index].first_value; value != kNone; value = value_entries_[value].next) {
+                indices.push_back(value_entries_[value].game_index);
+        }
+        for (std::uint32_t child = nodes_[node_index].first_child; child != kNone; child = nodes_[child].next_sibling) {
+                CollectGameIndicesRecursive(child, indices);
+        }
+}
+
+std::vector<FuzzyMatch>
+PrefixTree::FuzzySearch(const std::string& query, std::uint32_t max_distance, size_t max_results) const
+{
+        FuzzyState state;
+        state.query = ToLower(query);
+        if (state.query.empty() || max_results == 0) {
+                return {};
+        }
+        state.max_distance = std::min<std::uint32_t>(max_distance, state.query.size());
+        state.row_width    = state.query.size() + 1;
+        state.rows.resize(state.row_width);
+        for (size_t j = 0; j < state.row_width; ++j) {
+                state.rows[j] = static_cast<std::uint16_t>(std::min<size_t>(j, state.max_distance + 1));
+        }
+        state.best.push_back(state.rows.back());
+        state.reach.push_back(std::min<size_t>(state.max_distance + 1, state.row_width));
+
+        FuzzySearchRecursive(0, 0, state);
+
+        /* * Among equally close matches prefer the name that is closest as a whole, e.g. "Portal 2" over
+         * * "Portal 5" for "portal2", then the most played. */
+        std::vector<std::uint16_t> scratch;
+        for (auto& match : state.matches) {
+                match.name_distance =
+                    WordCharacterEditDistance(state.query, steam_game_collection.LowerName(match.game_index), scratch);
+        }
+        auto&        matches = state.matches;
+        const size_t keep    = std::min(max_results, matches.size());
+        std::partial_sort(
+            matches.begin(), matches.begin() + keep, matches.end(), [](const FuzzyMatch& a, const FuzzyMatch& b) {
+                    if (a.distance != b.distance) {
+                            return a.distance < b.distance;
+                    }
+                    if (a.name_distance != b.name_distance) {
+                            return a.name_distance < b.name_distance;
+                    }
+                    return RanksHigherByPlaytime(a.game_index, b.game_index);
+            });
+        matches.resize(keep);
+        return matches;
+}
+
+void PrefixTree::FuzzySearchRecursive(std::uint32_t node_index, size_t level, FuzzyState& state) const
+{
+        const Node&  node  = nodes_[node_index];
+        const size_t width = state.row_width;
+        if (state.rows.size() < (level + 2) * width) {
+                state.rows.resize((level + 2) * width);
+                state.best.resize(level + 2);
+                state.reach.resize(level + 2);
+        }
+
+        /* * Standard Levenshtein recurrence, except that column 0 resets to 0 after every word separator.
+         * * Cells saturate at cap = max_distance + 1 and only the cells before `reach` can be below cap
+         * * (Ukkonen's cut-off), so each character usually touches a handful of cells. A row with reach 0 is
+         * * dead until the next separator and the rest of that word is skipped. */
+        std::uint16_t* row = state.rows.data() + (level + 1) * width;
+        std::copy_n(state.rows.data() + level * width, width, row);
+        size_t        reach = state.reach[level];
+        std::uint16_t best  = state.best[level];
+        const auto    cap   = static_cast<std::uint16_t>(state.max_distance + 1);
 
-        for (size_t index : current_node->game_indices) {
-                indices.push_back(index);
+        for (std::uint32_t i = 0; i < node.label_length; ++i) {
+                const char ch      = label_arena_[node.label_offset + i];
+                const bool is_word = IsWordCharacter(ch);
+                if (reach == 0) {
+                        if (is_word) {
+                                continue;
+                        }
+                        /* * A separator revives a dead row: only a match starting here can still be close enough. */
+                        for (size_t j = 0; j < width; ++j) {
+                                row[j] = static_cast<std::uint16_t>(std::min<size_t>(j, cap));
+                        }
+                        reach = std::min<size_t>(cap, width);
+                        best  = std::min(best, row[width - 1]);
+                        continue;
+                }
+
+                std::uint16_t diagonal  = row[0];
+                row[0]                  = is_word ? std::min(static_cast<std::uint16_t>(row[0] + 1), cap) : 0;
+                size_t        new_reach = row[0] < cap ? 1 : 0;
+                for (size_t j = 1; j < width; ++j) {
+                        if (j > reach && row[j - 1] + 1 >= cap) {
+                                break; /* * Everything further right is still saturated. */
+                        }
+                        const std::uint16_t above    = row[j];
+                        const bool          mismatch = state.query[j - 1] != ch;
+                        row[j]                       = std::min({ static_cast<std::uint16_t>(row[j - 1] + 1),
+                                                                  static_cast<std::uint16_t>(above + 1),
+                                                                  static_cast<std::uint16_t>(diagonal + mismatch),
+                                                                  cap });
+                        if (row[j] < cap) {
+                                new_reach = j + 1;
+                        }
+                        diagonal = above;
+                }
+                reach = new_reach;
+                best  = std::min(best, row[width - 1]);
+        }
+        state.reach[level + 1] = reach;
+        state.best[level + 1]  = best;
+
+        if (best <= state.max_distance) {
+                for (std::uint32_t value = node.first_value; value != kNone; value = value_entries_[value].next) {
+                        state.matches.push_back({ value_entries_[value].game_index, best, 0 });
+                }
         }
-        for (const auto& pair : current_node->children) {
-                CollectGameIndicesRecursive(pair.second, indices);
+        for (std::uint32_t child = node.first_child; child != kNone; child = nodes_[child].next_sibling) {
+                FuzzySearchRecursive(child, level + 1, state);
         }
 }
 
-} 
+} // namespace prefix
 STEAM_END_NAMESPACE
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include <algorithm> // For std::min in HandleHistoryCommand
 #include <iostream>
+#include <mutex>     // For std::unique_lock in ProcessUserCommand
 #include <sstream>   // For std::stringstream in ParseCommandLine
 #include <stdexcept> // For std::runtime_error, std::invalid_argument, std::out_of_range
 #include <string>
@@ -54,43 +55,136 @@ std::vector<std::string> ParseCommandLine(const std::string& command_line)
         return arguments;
 }
 
+/**
+ * @brief Parses 'search --top <N> [-p | -n] [prefix...]' and runs the ranked search.
+ */
+static void HandleTopSearchArguments(const std::vector<std::string>& arguments)
+{
+        size_t count = 0;
+        try {
+                if (arguments.size() > 2) {
+                        const int parsed = std::stoi(arguments[2]);
+                        count            = parsed > 0 ? static_cast<size_t>(parsed) : 0;
+                }
+        } catch (const std::exception&) {
+                count = 0;
+        }
+        if (count == 0) {
+                print(fg(color::indian_red), "Error: 'search --top' requires a positive result count.\n");
+                print(fg(color::yellow), "Usage: search --top <N> [-p | -n] [prefix]\n");
+                return;
+        }
+
+        prefix::SearchRank rank  = prefix::SearchRank::PLAYTIME;
+        size_t             first = 3;
+        if (arguments.size() > 3 && (arguments[3] == "-p" || arguments[3] == "-n")) {
+                rank  = arguments[3] == "-n" ? prefix::SearchRank::NAME : prefix::SearchRank::PLAYTIME;
+                first = 4;
+        }
+        std::string search_term;
+        for (size_t i = first; i < arguments.size(); ++i) {
+                search_term += (search_term.empty() ? "" : " ") + arguments[i];
+        }
+        handler::HandleTopSearchCommand(search_term, count, rank);
+}
+
+static void HandleTrendArguments(const std::vector<std::string>& arguments)
+{
+        int days  = kDefaultTrendDays;
+        int count = static_cast<int>(kTrendResultLimit);
+        try {
+                if (arguments.size() > 1) {
+                        days = std::stoi(arguments[1]);
+                }
+                if (arguments.size() > 2) {
+                        count = std::stoi(arguments[2]);
+                }
+        } catch (const std::exception&) {
+                days = 0;
+        }
+        if (days <= 0 || count <= 0) {
+                print(fg(color::indian_red), "Error: 'trend' takes a positive number of days and of games.\n");
+                print(fg(color::yellow), "Usage: trend [days] [N]\n");
+                return;
+        }
+        handler::HandleTrendCommand(days, static_cast<size_t>(count));
+}
+
+/* * Commands that change the library, the relations or the profile store; a read-only process refuses them. */
+static bool ChangesData(const std::vector<std::string>& arguments)
+{
+        const std::string& command = arguments[0];
+        return command == "fetch" || command == "fetch-many" || command == "relate" || command == "undo"
+               || (command == "profile" && arguments.size() > 1 && arguments[1] == "switch");
+}
+
 void ProcessUserCommand(const std::vector<std::string>& arguments)
 {
         if (arguments.empty()) {
                 return;
         }
         const std::string& command = arguments[0];
+        // Everything but these reads or changes the library, so it waits for the startup load to finish.
+        std::unique_lock<std::mutex> data_lock;
+        if (command != "help" && command != "history" && command != "exit") {
+                loader::WaitUntilDataLoaded();
+                /* * 'save' waits on the save worker, which takes this lock to encode the library. */
+                if (command != "save") {
+                        data_lock = loader::LockData();
+                }
+                loader::ReloadPublishedData();
+        }
+        if (steam_read_only && ChangesData(arguments)) {
+                print(fg(color::indian_red), "Error: '{}' is not available with STEAM_READ_ONLY=1.\n", command);
+                return;
+        }
 
         if (command == "fetch") {
                 if (arguments.size() < 2) {
                         print(fg(color::indian_red), "Error: 'fetch' requires a SteamID or Vanity URL.\n");
                         print(fg(color::yellow), "Usage: fetch <SteamID64/VanityURLName>\n");
                 } else {
-                        handler::FetchGamesFromSteamApi(arguments[1]);
+                        loader::WaitUntilApiKeyChecked();
+                        if (!steam_api_key.empty() || loader::PromptForApiKey()) {
+                                handler::FetchGamesFromSteamApi(arguments[1]);
+                        }
+                }
+        } else if (command == "fetch-many") {
+                if (arguments.size() < 2) {
+                        print(
+                            fg(color::indian_red),
+                            "Error: 'fetch-many' requires SteamIDs, vanity names or a file of them.\n");
+                        print(fg(color::yellow), "Usage: fetch-many <file|SteamID|VanityURLName>...\n");
+                } else {
+                        loader::WaitUntilApiKeyChecked();
+                        if (!steam_api_key.empty() || loader::PromptForApiKey()) {
+                                handler::HandleFetchManyCommand(
+                                    std::vector<std::string>(arguments.begin() + 1, arguments.end()));
+                        }
                 }
+        } else if (command == "search" && arguments.size() > 2 && arguments[1] == "--fuzzy") {
+                std::string search_term = arguments[2];
+                for (size_t i = 3; i < arguments.size(); ++i)
+                        search_term += " " + arguments[i];
+                handler::HandleFuzzySearchCommand(search_term);
+        } else if (command == "search" && arguments.size() > 2 && arguments[1] == "--contains") {
+                std::string search_text = arguments[2];
+                for (size_t i = 3; i < arguments.size(); ++i)
+                        search_text += " " + arguments[i];
+                handler::HandleContainsSearchCommand(search_text);
+        } else if (command == "search" && arguments.size() > 1 && arguments[1] == "--top") {
+                HandleTopSearchArguments(arguments);
         } else if (command == "search") {
                 if (arguments.size() < 2) {
                         print(fg(color::indian_red), "Error: 'search' requires a game name prefix.\n");
                         print(fg(color::yellow), "Usage: search <prefix>\n");
+                } else if (arguments.size() > 2) {
+                        // Unquoted words: search "dark souls" is a name prefix, search souls dark matches
+                        // every word in any order through the word index.
+                        handler::HandleWordSearchCommand(
+                            std::vector<std::string>(arguments.begin() + 1, arguments.end()));
                 } else {
-                        // Collect all arguments after "search" for multi-word search terms if not quoted
-                        // For now, assume ParseCommandLine handles quoted arguments correctly,
-                        // and unquoted multi-word search will take arguments[1] only.
-                        // If search "game name", arguments will be ["search", "game name"]
-                        // If search game name, arguments will be ["search", "game", "name"]
-                        // We'll pass arguments[1] to handler, which might need to be smarter or
-                        // users must quote multi-word prefixes. For now, pass arguments[1].
-                        std::string search_term = arguments[1];
-                        if (arguments.size() > 2) { // if unquoted multi-word, join them. Not ideal.
-                                for (size_t i = 2; i < arguments.size(); ++i)
-                                        search_term += " " + arguments[i];
-                                print(
-                                    fg(color::yellow),
-                                    "Searching for \"{}\". For multi-word search, consider quotes: search \"{}\"\n",
-                                    search_term,
-                                    search_term);
-                        }
-                        handler::HandleSearchCommand(search_term);
+                        handler::HandleSearchCommand(arguments[1]);
                 }
         } else if (command == "count") {
                 handler::HandleCountPlayedCommand();
@@ -110,6 +204,27 @@ void ProcessUserCommand(const std::vector<std::string>& arguments)
                         }
                 }
                 handler::HandleListGamesCommand(list_format);
+        } else if (command == "stats") {
+                handler::HandleStatsCommand();
+        } else if (command == "profiles") {
+                handler::HandleProfilesCommand();
+        } else if (command == "profile") {
+                if (arguments.size() < 3
+                    || (arguments[1] != "switch" && arguments[1] != "info" && arguments[1] != "owners")) {
+                        print(fg(color::indian_red), "Error: 'profile' requires a subcommand and an argument.\n");
+                        print(
+                            fg(color::yellow),
+                            "Usage: profile switch <SteamID|name> | profile info <SteamID|name> | "
+                            "profile owners <AppID|name>\n");
+                } else if (arguments[1] == "switch") {
+                        handler::HandleProfileSwitchCommand(arguments[2]);
+                } else if (arguments[1] == "info") {
+                        handler::HandleProfileInfoCommand(arguments[2]);
+                } else {
+                        handler::HandleProfileOwnersCommand(arguments[2]);
+                }
+        } else if (command == "trend") {
+                HandleTrendArguments(arguments);
         } else if (command == "help") {
                 handler::ShowHelp();
         } else if (command == "export") {
@@ -142,6 +257,8 @@ void ProcessUserCommand(const std::vector<std::string>& arguments)
                 }
         } else if (command == "undo") {
                 handler::HandleUndoCommand();
+        } else if (command == "save") {
+                handler::HandleSaveCommand();
         } else if (command == "exit") {
                 throw std::runtime_error("exit");
         } else if (command == "history") {
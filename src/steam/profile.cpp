@@ -0,0 +1,122 @@
+#include "steam/profile.hpp"
+
+#include "steam/catalog.hpp"
+#include "steam/loader.hpp"  // For SaveGamesData
+#include "steam/utility.hpp" // For CompareIgnoreCase
+
+STEAM_BEGIN_NAMESPACE
+namespace profile {
+
+std::uint32_t ProfileStore::InternApp(int app_id, std::string_view name)
+{
+        auto [index_it, inserted] = app_index_by_id_.emplace(app_id, static_cast<std::uint32_t>(app_ids_.size()));
+        const std::uint32_t app_index = index_it->second;
+        if (inserted) {
+                app_ids_.push_back(app_id);
+                name_offsets_.push_back(static_cast<std::uint32_t>(name_arena_.size()));
+                name_lengths_.push_back(static_cast<std::uint32_t>(name.size()));
+                name_arena_.append(name);
+        } else if (AppName(app_index) != name) {
+                /* * The old bytes stay behind in the arena; renames are rare enough not to compact for. */
+                name_offsets_[app_index] = static_cast<std::uint32_t>(name_arena_.size());
+                name_lengths_[app_index] = static_cast<std::uint32_t>(name.size());
+                name_arena_.append(name);
+        }
+        return app_index;
+}
+
+std::uint32_t ProfileStore::FindApp(int app_id) const
+{
+        auto index_it = app_index_by_id_.find(app_id);
+        return index_it == app_index_by_id_.end() ? kNoApp : index_it->second;
+}
+
+void ProfileStore::StoreProfile(const data::UserData& user, const data::GameCollection& games)
+{
+        Profile& stored = profiles_[user.steam_id];
+        stored.user     = user;
+        stored.app_indices.clear();
+        stored.playtimes.clear();
+        stored.app_indices.reserve(games.size());
+        stored.playtimes.reserve(games.size());
+        for (size_t index = 0; index < games.size(); ++index) {
+                stored.app_indices.push_back(InternApp(games.AppId(index), games.Name(index)));
+                stored.playtimes.push_back(games.Playtime(index));
+        }
+        stored.app_indices.shrink_to_fit();
+        stored.playtimes.shrink_to_fit();
+}
+
+bool ProfileStore::StoreCurrentProfile()
+{
+        const data::UserData& user = steam_current_user_data;
+        if (user.steam_id.empty()
+            || (user.steam_id == current_user_.steam_id && user.username == current_user_.username
+                && user.location == current_user_.location && steam_game_collection.Version() == current_version_
+                && profiles_.count(user.steam_id) > 0)) {
+                return false;
+        }
+        StoreProfile(user, steam_game_collection);
+        MarkCurrentStored();
+        return true;
+}
+
+void ProfileStore::MarkCurrentStored()
+{
+        current_user_    = steam_current_user_data;
+        current_version_ = steam_game_collection.Version();
+}
+
+const Profile* ProfileStore::FindProfile(const std::string& steam_id_or_username) const
+{
+        auto profile_it = profiles_.find(steam_id_or_username);
+        if (profile_it != profiles_.end()) {
+                return &profile_it->second;
+        }
+        for (const auto& [steam_id, stored] : profiles_) {
+                if (CompareIgnoreCase(stored.user.username, steam_id_or_username) == 0) {
+                        return &stored;
+                }
+        }
+        return nullptr;
+}
+
+size_t ProfileStore::MemoryUsage() const
+{
+        /* * Hash node: next pointer and the pair; red-black tree node: three pointers and a color word. */
+        size_t bytes = app_ids_.capacity() * sizeof(int) + name_offsets_.capacity() * sizeof(std::uint32_t)
+                       + name_lengths_.capacity() * sizeof(std::uint32_t) + name_arena_.capacity()
+                       + app_index_by_id_.bucket_count() * sizeof(void*)
+                       + app_index_by_id_.size() * (sizeof(void*) + sizeof(std::pair<int, std::uint32_t>));
+        for (const auto& [steam_id, stored] : profiles_) {
+                bytes += 4 * sizeof(void*) + sizeof(steam_id) + sizeof(stored) + steam_id.capacity()
+                         + stored.user.username.capacity() + stored.user.location.capacity()
+                         + stored.user.steam_id.capacity() + stored.app_indices.capacity() * sizeof(std::uint32_t)
+                         + stored.playtimes.capacity() * sizeof(int);
+        }
+        return bytes;
+}
+
+bool ActivateProfile(const std::string& steam_id_or_username)
+{
+        const Profile* stored = steam_profile_store.FindProfile(steam_id_or_username);
+        if (stored == nullptr) {
+                return false;
+        }
+        data::GameCollection games;
+        games.reserve(stored->app_indices.size());
+        for (size_t game = 0; game < stored->app_indices.size(); ++game) {
+                const std::uint32_t app_index = stored->app_indices[game];
+                games.push_back({ std::string(steam_profile_store.AppName(app_index)),
+                                  steam_profile_store.AppId(app_index),
+                                  stored->playtimes[game] });
+        }
+        catalog::LoadColumns(games.Columns());
+        steam_current_user_data = stored->user;
+        steam_has_fetched_data  = true;
+        steam_profile_store.MarkCurrentStored(); /* * The library was just copied from the profile */
+        loader::SaveGamesData();
+        return true;
+}
+} // namespace profile
+STEAM_END_NAMESPACE
@@ -0,0 +1,934 @@
+#include "steam/snapshot.hpp"
+
+#include "steam/catalog.hpp"
+#include "steam/mapped_file.hpp"
+#include "steam/profile.hpp"
+#include "steam/utility.hpp" // For WriteFileAtomically
+
+#include <algorithm> // For std::all_of, std::equal, std::is_sorted
+#include <cctype>    // For std::isxdigit
+#include <cstring>   // For std::memcpy, std::memcmp
+#include <memory>    // For std::unique_ptr
+#include <optional>
+#include <type_traits>
+
+STEAM_BEGIN_NAMESPACE
+namespace snapshot {
+
+static constexpr char          kGamesMagic[8]        = { 'S', 'T', 'M', 'G', 'A', 'M', 'E', 'S' };
+static constexpr char          kIndexMagic[8]        = { 'S', 'T', 'M', 'I', 'N', 'D', 'E', 'X' };
+static constexpr char          kProfileMagic[8]      = { 'S', 'T', 'M', 'P', 'R', 'O', 'F', 'S' };
+static constexpr char          kPointerMagic[8]      = { 'S', 'T', 'M', 'P', 'O', 'I', 'N', 'T' };
+static constexpr std::uint32_t kGamesFormatVersion   = 2;
+static constexpr std::uint32_t kIndexFormatVersion   = 2; /* * 2: grams and map entries sorted by key */
+static constexpr std::uint32_t kProfileFormatVersion = 1;
+static constexpr std::uint32_t kByteOrderMark        = 0x01020304; /* * Reads back differently on the other endianness */
+static constexpr size_t        kAlignment            = 8;
+
+enum GamesSection : size_t
+{
+        kUsername,
+        kLocation,
+        kSteamId,
+        kAppIds,
+        kPlaytimes,
+        kNameOffsets,
+        kNameLengths,
+        kLowerNameOffsets,
+        kLowerNameLengths,
+        kNameArena,
+        kGamesSectionCount
+};
+
+enum IndexSection : size_t
+{
+        kIndexParameters, /* * Layout constants the index was built with; a mismatch forces a rebuild */
+        kTreeNodes,
+        kTreeValues,
+        kTreeLabels,
+        kTreeTopCaches,
+        kTreeFreeNodes,
+        kTreeFreeValues,
+        kTreeFreeTopSlots,
+        kNameMapIndices,
+        kAppIdMapIndices,
+        kInfixGrams,
+        kInfixOffsets, /* * One more entry than grams; list i is postings[offsets[i], offsets[i + 1]) */
+        kInfixPostings,
+        kTokenWordOffsets,
+        kTokenWords,
+        kTokenOffsets,
+        kTokenPostings,
+        kIndexSectionCount
+};
+
+enum ProfileSection : size_t
+{
+        kDictionaryAppIds,
+        kDictionaryNameOffsets,
+        kDictionaryNameLengths,
+        kDictionaryNameArena,
+        kProfileStringOffsets, /* * Three strings per profile (SteamID, username, location), plus one end offset */
+        kProfileStrings,
+        kProfileGameOffsets, /* * One more entry than profiles; profile i owns games [offsets[i], offsets[i + 1]) */
+        kProfileAppIndices,
+        kProfilePlaytimes,
+        kProfileSectionCount
+};
+
+struct Header
+{
+        char          magic[8];
+        std::uint32_t format_version;
+        std::uint32_t byte_order;
+        std::uint64_t game_count;
+        std::uint64_t source_hash;   /* * Index files: checksum of the games file they were built from */
+        std::uint64_t file_size;
+        std::uint64_t checksum;      /* * Of every byte after the header */
+        std::uint64_t section_count; /* * Entries in the section table that follows the header */
+};
+
+/* * A published games path: names the versioned games and index files instead of holding the library. */
+struct Pointer
+{
+        char          magic[8];
+        std::uint64_t version; /* * Checksum of the games file, and source hash of the index file, it names */
+};
+
+struct SectionEntry
+{
+        std::uint64_t offset; /* * From the start of the file */
+        std::uint64_t size;   /* * In bytes */
+};
+static_assert(std::is_trivially_copyable_v<Header>, "Header is written and read with memcpy");
+static_assert(std::is_trivially_copyable_v<Pointer>, "Pointer is written and read with fwrite and fread");
+static_assert(sizeof(Header) % kAlignment == 0 && sizeof(SectionEntry) % kAlignment == 0,
+              "Sections must start aligned");
+static_assert(std::is_trivially_copyable_v<prefix::PrefixTree::Node>, "Tree nodes are stored verbatim");
+
+struct Payload
+{
+        const void* data;
+        size_t      size;
+};
+
+/* * Word-at-a-time multiply-xorshift hash; catches truncation and bit rot at memory bandwidth. */
+static std::uint64_t Checksum(const char* bytes, size_t size)
+{
+        constexpr std::uint64_t kMultiplier = 0x9E3779B97F4A7C15ull;
+        std::uint64_t           hash        = size * kMultiplier;
+        size_t                  position    = 0;
+        for (; position + 8 <= size; position += 8) {
+                std::uint64_t word;
+                std::memcpy(&word, bytes + position, 8);
+                hash = (hash ^ word) * kMultiplier;
+                hash ^= hash >> 29;
+        }
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, bytes + position, size - position);
+        hash = (hash ^ tail) * kMultiplier;
+        return hash ^ (hash >> 32);
+}
+
+/**
+ * @brief Lays out a header, its section table and the payloads, each padded to kAlignment.
+ * @param checksum Receives the checksum stored in the header, if not null.
+ */
+static std::string BuildImage(const char (&magic)[8],
+                              std::uint32_t               format_version,
+                              std::uint64_t               source_hash,
+                              const std::vector<Payload>& payloads,
+                              std::uint64_t*              checksum = nullptr)
+{
+        Header header = {};
+        std::memcpy(header.magic, magic, sizeof(header.magic));
+        header.format_version = format_version;
+        header.byte_order     = kByteOrderMark;
+        header.game_count     = steam_game_collection.size();
+        header.source_hash    = source_hash;
+        header.section_count  = payloads.size();
+
+        std::vector<SectionEntry> sections(payloads.size());
+        size_t                    file_size = sizeof(Header) + sections.size() * sizeof(SectionEntry);
+        for (size_t section = 0; section < payloads.size(); ++section) {
+                sections[section] = { file_size, payloads[section].size };
+                file_size += (payloads[section].size + kAlignment - 1) / kAlignment * kAlignment;
+        }
+        header.file_size = file_size;
+
+        /* * Assembled in memory first so the checksum can go into the header ahead of the data. */
+        std::string image(file_size, '\0');
+        std::memcpy(&image[sizeof(Header)], sections.data(), sections.size() * sizeof(SectionEntry));
+        for (size_t section = 0; section < payloads.size(); ++section) {
+                if (payloads[section].size > 0) {
+                        std::memcpy(&image[sections[section].offset], payloads[section].data, payloads[section].size);
+                }
+        }
+        header.checksum = Checksum(image.data() + sizeof(Header), file_size - sizeof(Header));
+        std::memcpy(&image[0], &header, sizeof(Header));
+        if (checksum != nullptr) {
+                *checksum = header.checksum;
+        }
+        return image;
+}
+
+bool WriteImage(const std::string& image, const std::filesystem::path& path)
+{
+        return WriteFileAtomically(path, [&image](std::FILE* file) {
+                return std::fwrite(image.data(), 1, image.size(), file) == image.size();
+        });
+}
+
+/* * Reads only the header at the start of a file; false if the file is missing or shorter than a header. */
+static bool ReadHeader(const std::filesystem::path& path, Header& header)
+{
+        std::FILE* file = OpenFile(path, "rb");
+        if (file == nullptr) {
+                return false;
+        }
+        const bool read = std::fread(&header, sizeof(Header), 1, file) == 1;
+        std::fclose(file);
+        return read;
+}
+
+bool FileHoldsImage(const std::filesystem::path& path, const std::string& image)
+{
+        Header header = {};
+        return image.size() >= sizeof(Header) && ReadHeader(path, header)
+               && std::memcmp(&header, image.data(), sizeof(Header)) == 0;
+}
+
+/* * The version an image is published under: its checksum, which is also what its index's source hash holds. */
+static std::uint64_t ImageVersion(const std::string& image)
+{
+        Header header = {};
+        std::memcpy(&header, image.data(), sizeof(Header));
+        return header.checksum;
+}
+
+/* * "games.bin" published as version 0x1f becomes "games.000000000000001f.bin"; likewise for the index. */
+static std::filesystem::path VersionedPath(const std::filesystem::path& path, std::uint64_t version)
+{
+        std::filesystem::path versioned = path;
+        versioned.replace_filename(
+            fmt::format("{}.{:016x}{}", path.stem().string(), version, path.extension().string()));
+        return versioned;
+}
+
+/* * The version a pointer file names; nothing if path is missing or holds anything else, such as an image. */
+static std::optional<std::uint64_t> ReadPointer(const std::filesystem::path& path)
+{
+        std::FILE* file = OpenFile(path, "rb");
+        if (file == nullptr) {
+                return std::nullopt;
+        }
+        Pointer    pointer = {};
+        const bool read    = std::fread(&pointer, sizeof(Pointer), 1, file) == 1 && std::fgetc(file) == EOF;
+        std::fclose(file);
+        if (!read || std::memcmp(pointer.magic, kPointerMagic, sizeof(kPointerMagic)) != 0) {
+                return std::nullopt;
+        }
+        return pointer.version;
+}
+
+/* * The games and index files a published games path stands for. */
+struct SnapshotFiles
+{
+        std::filesystem::path games;
+        std::filesystem::path index;
+};
+
+static SnapshotFiles ResolveSnapshot(const std::filesystem::path& games_path, const std::filesystem::path& index_path)
+{
+        if (const std::optional<std::uint64_t> version = ReadPointer(games_path)) {
+                return { VersionedPath(games_path, *version), VersionedPath(index_path, *version) };
+        }
+        /* * Written before snapshots were versioned: games_path holds the image itself. */
+        return { games_path, index_path };
+}
+
+/* * Whether path holds an index file of this format built for the games file published as version. */
+static bool IndexBuiltFor(const std::filesystem::path& path, std::uint64_t version)
+{
+        Header header = {};
+        return ReadHeader(path, header) && std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) == 0
+               && header.format_version == kIndexFormatVersion && header.byte_order == kByteOrderMark
+               && header.source_hash == version;
+}
+
+/* * Whether name is base's stem, a dot, 16 hex digits and base's extension, but not for version. */
+static bool IsStaleVersion(const std::string& name, const std::filesystem::path& base, std::uint64_t version)
+{
+        const std::string stem      = base.stem().string() + ".";
+        const std::string extension = base.extension().string();
+        if (name.size() != stem.size() + 16 + extension.size() || name.compare(0, stem.size(), stem) != 0
+            || name.compare(name.size() - extension.size(), extension.size(), extension) != 0) {
+                return false;
+        }
+        const std::string tag = name.substr(stem.size(), 16);
+        return std::all_of(tag.begin(), tag.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); })
+               && tag != fmt::format("{:016x}", version);
+}
+
+/**
+ * @brief Deletes the files of every version but this one, and an index file written before versioning.
+ * * Failures are ignored: on Windows a file a reader still maps cannot be deleted, so it is left for the
+ * * cleanup after the next publish.
+ */
+static void RemoveStaleVersions(const std::filesystem::path& games_path,
+                                const std::filesystem::path& index_path,
+                                std::uint64_t                version)
+{
+        std::error_code error;
+        std::filesystem::remove(index_path, error);
+        const std::filesystem::path directory = games_path.has_parent_path() ? games_path.parent_path() : ".";
+        std::filesystem::directory_iterator entry(directory, error);
+        for (; !error && entry != std::filesystem::directory_iterator(); entry.increment(error)) {
+                const std::string name = entry->path().filename().string();
+                if (IsStaleVersion(name, games_path, version) || IsStaleVersion(name, index_path, version)) {
+                        std::error_code remove_error;
+                        std::filesystem::remove(entry->path(), remove_error);
+                }
+        }
+}
+
+bool FileHoldsSnapshot(const std::filesystem::path& games_path,
+                       const std::filesystem::path& index_path,
+                       const std::string&           games_image)
+{
+        const std::uint64_t version = ImageVersion(games_image);
+        return ReadPointer(games_path) == version && FileHoldsImage(VersionedPath(games_path, version), games_image)
+               && IndexBuiltFor(VersionedPath(index_path, version), version);
+}
+
+/* * A mapped snapshot whose header, section table and checksum have been checked. */
+class SnapshotReader
+{
+      public:
+        bool Open(const std::filesystem::path& path,
+                  const char (&magic)[8],
+                  std::uint32_t format_version,
+                  size_t        section_count)
+        {
+                const size_t table_end = sizeof(Header) + section_count * sizeof(SectionEntry);
+                if (!file_.Open(path) || file_.size() < table_end) {
+                        return false;
+                }
+                std::memcpy(&header_, file_.data(), sizeof(Header));
+                if (std::memcmp(header_.magic, magic, sizeof(header_.magic)) != 0
+                    || header_.format_version != format_version || header_.byte_order != kByteOrderMark
+                    || header_.file_size != file_.size() || header_.section_count != section_count) {
+                        return false;
+                }
+                sections_.resize(section_count);
+                std::memcpy(sections_.data(), file_.data() + sizeof(Header), section_count * sizeof(SectionEntry));
+                for (const SectionEntry& section : sections_) {
+                        if (section.offset < table_end || section.offset % kAlignment != 0
+                            || section.offset > file_.size() || section.size > file_.size() - section.offset) {
+                                return false;
+                        }
+                }
+                return Checksum(file_.data() + sizeof(Header), file_.size() - sizeof(Header)) == header_.checksum;
+        }
+
+        const Header& header() const
+        {
+                return header_;
+        }
+
+        size_t size() const
+        {
+                return file_.size();
+        }
+
+        std::string_view Bytes(size_t section) const
+        {
+                return { file_.data() + sections_[section].offset, static_cast<size_t>(sections_[section].size) };
+        }
+
+        /**
+         * @brief Views a section as an array of T.
+         * @return False if the section's size is not a whole number of elements.
+         */
+        template <typename T> bool Array(size_t section, ArrayView<T>& elements) const
+        {
+                const std::string_view bytes = Bytes(section);
+                if (bytes.size() % sizeof(T) != 0) {
+                        return false;
+                }
+                elements = { reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T) };
+                return true;
+        }
+
+        /* * Views a section as exactly expected_count elements of T; nullptr if its size differs. */
+        template <typename T> const T* Column(size_t section, size_t expected_count) const
+        {
+                ArrayView<T> elements;
+                return Array(section, elements) && elements.size == expected_count ? elements.data : nullptr;
+        }
+
+      private:
+        MappedFile                file_;
+        Header                    header_ = {};
+        std::vector<SectionEntry> sections_;
+};
+
+/* * Layout constants an index file must agree with before its arrays can be reused. */
+static std::vector<std::uint32_t> IndexParameters()
+{
+        return { static_cast<std::uint32_t>(sizeof(prefix::PrefixTree::Node)),
+                 prefix::PrefixTree::kTopCacheSize,
+                 static_cast<std::uint32_t>(infix::InfixIndex::kGramLength) };
+}
+
+/**
+ * @brief Encodes the current search indexes for the games file with the given checksum.
+ * * Map entries and trigrams are sorted by key, so a reader can binary search them where they are mapped.
+ */
+static std::string BuildIndexImage(std::uint64_t source_hash)
+{
+        catalog::OwnIndexes();
+        const auto& tree = prefix::steam_game_name_prefix_tree;
+
+        std::vector<std::uint32_t> name_map_indices;
+        name_map_indices.reserve(prefix::steam_game_name_to_index_map.size());
+        for (const auto& entry : prefix::steam_game_name_to_index_map) {
+                name_map_indices.push_back(static_cast<std::uint32_t>(entry.second));
+        }
+        std::sort(name_map_indices.begin(), name_map_indices.end(), [](std::uint32_t a, std::uint32_t b) {
+                return steam_game_collection.LowerName(a) < steam_game_collection.LowerName(b);
+        });
+        std::vector<std::uint32_t> app_id_map_indices;
+        app_id_map_indices.reserve(prefix::steam_game_app_id_to_index_map.size());
+        for (const auto& entry : prefix::steam_game_app_id_to_index_map) {
+                app_id_map_indices.push_back(static_cast<std::uint32_t>(entry.second));
+        }
+        std::sort(app_id_map_indices.begin(), app_id_map_indices.end(), [](std::uint32_t a, std::uint32_t b) {
+                return steam_game_collection.AppId(a) < steam_game_collection.AppId(b);
+        });
+
+        using GramPosting = std::pair<const std::uint32_t, std::vector<std::uint32_t>>;
+        std::vector<const GramPosting*> grams;
+        grams.reserve(infix::steam_game_name_infix_index.postings_.size());
+        for (const auto& entry : infix::steam_game_name_infix_index.postings_) {
+                grams.push_back(&entry);
+        }
+        std::sort(grams.begin(), grams.end(), [](const GramPosting* a, const GramPosting* b) {
+                return a->first < b->first;
+        });
+        std::vector<std::uint32_t> infix_grams;
+        std::vector<std::uint32_t> infix_offsets(1, 0);
+        std::vector<std::uint32_t> infix_postings;
+        infix_grams.reserve(grams.size());
+        infix_offsets.reserve(grams.size() + 1);
+        for (const GramPosting* gram : grams) {
+                infix_grams.push_back(gram->first);
+                infix_postings.insert(infix_postings.end(), gram->second.begin(), gram->second.end());
+                infix_offsets.push_back(static_cast<std::uint32_t>(infix_postings.size()));
+        }
+
+        std::vector<std::uint32_t> token_word_offsets(1, 0);
+        std::string                token_words;
+        std::vector<std::uint32_t> token_offsets(1, 0);
+        std::vector<std::uint32_t> token_postings;
+        for (const auto& [word, posting] : token::steam_game_name_token_index.postings_) {
+                token_words.append(word);
+                token_word_offsets.push_back(static_cast<std::uint32_t>(token_words.size()));
+                token_postings.insert(token_postings.end(), posting.begin(), posting.end());
+                token_offsets.push_back(static_cast<std::uint32_t>(token_postings.size()));
+        }
+
+        const auto array = [](const auto& values) {
+                return Payload{ values.data(), values.size() * sizeof(values[0]) };
+        };
+        const std::vector<std::uint32_t> parameters = IndexParameters();
+        return BuildImage(kIndexMagic,
+                          kIndexFormatVersion,
+                          source_hash,
+                          { array(parameters),
+                            array(tree.nodes_),
+                            array(tree.value_entries_),
+                            array(tree.label_arena_),
+                            array(tree.top_by_playtime_),
+                            array(tree.free_nodes_),
+                            array(tree.free_values_),
+                            array(tree.free_top_slots_),
+                            array(name_map_indices),
+                            array(app_id_map_indices),
+                            array(infix_grams),
+                            array(infix_offsets),
+                            array(infix_postings),
+                            array(token_word_offsets),
+                            array(token_words),
+                            array(token_offsets),
+                            array(token_postings) });
+}
+
+static bool AllBelow(const ArrayView<std::uint32_t>& values, size_t limit)
+{
+        return std::all_of(values.begin(), values.end(), [limit](std::uint32_t value) {
+                return value < limit;
+        });
+}
+
+/* * Offsets of offsets.size - 1 lists must start at 0, never decrease, and end exactly at total. */
+static bool AreOffsetsValid(const ArrayView<std::uint32_t>& offsets, size_t total)
+{
+        return offsets.size > 0 && offsets[0] == 0 && offsets[offsets.size - 1] == total
+               && std::is_sorted(offsets.begin(), offsets.end());
+}
+
+/* * Every array of an index file, viewed in place inside its mapping. */
+struct IndexArrays
+{
+        ArrayView<prefix::PrefixTree::Node>       nodes;
+        ArrayView<prefix::PrefixTree::ValueEntry> values;
+        std::string_view                          labels;
+        ArrayView<std::uint32_t>                  top_caches, free_nodes, free_values, free_top_slots;
+        ArrayView<std::uint32_t>                  name_map, app_id_map;
+        ArrayView<std::uint32_t>                  infix_grams, infix_offsets, infix_postings;
+        std::string_view                          token_words;
+        ArrayView<std::uint32_t>                  token_word_offsets, token_offsets, token_postings;
+};
+
+/**
+ * @brief Maps an index file built for the games file with the given checksum and views all of its arrays.
+ * * Every link and game index is bounds-checked, and so is every key order a borrowed index binary searches:
+ * * the checksum only proves the file is intact.
+ * @param columns The columns of that games file, whether or not they are loaded yet.
+ * @return False if the file is missing, stale or malformed.
+ */
+static bool OpenIndexArrays(SnapshotReader&              reader,
+                            const std::filesystem::path& index_path,
+                            std::uint64_t                source_hash,
+                            const data::GameColumns&     columns,
+                            IndexArrays&                 arrays)
+{
+        using Tree = prefix::PrefixTree;
+        if (!reader.Open(index_path, kIndexMagic, kIndexFormatVersion, kIndexSectionCount)
+            || reader.header().source_hash != source_hash || reader.header().game_count != columns.count) {
+                return false;
+        }
+        const std::vector<std::uint32_t> parameters        = IndexParameters();
+        const std::uint32_t*             stored_parameters = reader.Column<std::uint32_t>(kIndexParameters,
+                                                                                        parameters.size());
+        if (stored_parameters == nullptr || !std::equal(parameters.begin(), parameters.end(), stored_parameters)) {
+                return false;
+        }
+
+        IndexArrays& a = arrays;
+        if (!reader.Array(kTreeNodes, a.nodes) || !reader.Array(kTreeValues, a.values)
+            || !reader.Array(kTreeTopCaches, a.top_caches) || !reader.Array(kTreeFreeNodes, a.free_nodes)
+            || !reader.Array(kTreeFreeValues, a.free_values) || !reader.Array(kTreeFreeTopSlots, a.free_top_slots)
+            || !reader.Array(kNameMapIndices, a.name_map) || !reader.Array(kAppIdMapIndices, a.app_id_map)
+            || !reader.Array(kInfixGrams, a.infix_grams) || !reader.Array(kInfixOffsets, a.infix_offsets)
+            || !reader.Array(kInfixPostings, a.infix_postings)
+            || !reader.Array(kTokenWordOffsets, a.token_word_offsets) || !reader.Array(kTokenOffsets, a.token_offsets)
+            || !reader.Array(kTokenPostings, a.token_postings)) {
+                return false;
+        }
+        a.labels                = reader.Bytes(kTreeLabels);
+        a.token_words           = reader.Bytes(kTokenWords);
+        const size_t game_count = columns.count;
+        const size_t slot_count = a.top_caches.size / Tree::kTopCacheSize;
+
+        /* * Tree links may be kNone or must land inside their arrays; cached games must exist. */
+        const auto is_link = [](std::uint32_t link, size_t limit) {
+                return link == Tree::kNone || link < limit;
+        };
+        if (a.nodes.size == 0 || a.top_caches.size % Tree::kTopCacheSize != 0) {
+                return false;
+        }
+        for (const Tree::Node& node : a.nodes) {
+                if (size_t{ node.label_offset } + node.label_length > a.labels.size()
+                    || !is_link(node.first_child, a.nodes.size) || !is_link(node.next_sibling, a.nodes.size)
+                    || !is_link(node.first_value, a.values.size) || !is_link(node.top_slot, slot_count)) {
+                        return false;
+                }
+                if (node.top_slot != Tree::kNone) {
+                        const size_t first_entry = size_t{ node.top_slot } * Tree::kTopCacheSize;
+                        if (!AllBelow({ a.top_caches.data + first_entry, Tree::kTopCacheSize }, game_count)) {
+                                return false;
+                        }
+                }
+        }
+        for (const Tree::ValueEntry& value : a.values) {
+                if (value.game_index >= game_count || !is_link(value.next, a.values.size)) {
+                        return false;
+                }
+        }
+        if (!AllBelow(a.free_nodes, a.nodes.size) || !AllBelow(a.free_values, a.values.size)
+            || !AllBelow(a.free_top_slots, slot_count) || !AllBelow(a.name_map, game_count)
+            || !AllBelow(a.app_id_map, game_count) || a.infix_offsets.size != a.infix_grams.size + 1
+            || !AreOffsetsValid(a.infix_offsets, a.infix_postings.size) || !AllBelow(a.infix_postings, game_count)
+            || a.token_word_offsets.size != a.token_offsets.size
+            || !AreOffsetsValid(a.token_word_offsets, a.token_words.size())
+            || !AreOffsetsValid(a.token_offsets, a.token_postings.size) || !AllBelow(a.token_postings, game_count)) {
+                return false;
+        }
+
+        /* * Keys must strictly ascend; the game indices are known to be in range by now. */
+        const auto lower_name = [&columns](std::uint32_t index) {
+                return std::string_view(columns.name_arena.data() + columns.lower_name_offsets[index],
+                                        columns.lower_name_lengths[index]);
+        };
+        const auto word = [&a](size_t i) {
+                const std::uint32_t first = a.token_word_offsets[i];
+                return a.token_words.substr(first, a.token_word_offsets[i + 1] - first);
+        };
+        for (size_t i = 1; i < a.name_map.size; ++i) {
+                if (!(lower_name(a.name_map[i - 1]) < lower_name(a.name_map[i]))) {
+                        return false;
+                }
+        }
+        for (size_t i = 1; i < a.app_id_map.size; ++i) {
+                if (!(columns.app_ids[a.app_id_map[i - 1]] < columns.app_ids[a.app_id_map[i]])) {
+                        return false;
+                }
+        }
+        for (size_t i = 1; i < a.infix_grams.size; ++i) {
+                if (!(a.infix_grams[i - 1] < a.infix_grams[i])) {
+                        return false;
+                }
+        }
+        for (size_t i = 1; i + 1 < a.token_word_offsets.size; ++i) {
+                if (!(word(i - 1) < word(i))) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+/**
+ * @brief Fills every index with a copy of checked index arrays.
+ * * Runs inside catalog::LoadColumns, after steam_game_collection holds the matching snapshot's columns.
+ */
+static void RestoreIndexes(const IndexArrays& arrays)
+{
+        auto& tree = prefix::steam_game_name_prefix_tree;
+        tree.nodes_.assign(arrays.nodes.begin(), arrays.nodes.end());
+        tree.value_entries_.assign(arrays.values.begin(), arrays.values.end());
+        tree.label_arena_.assign(arrays.labels.data(), arrays.labels.data() + arrays.labels.size());
+        tree.top_by_playtime_.assign(arrays.top_caches.begin(), arrays.top_caches.end());
+        tree.free_nodes_.assign(arrays.free_nodes.begin(), arrays.free_nodes.end());
+        tree.free_values_.assign(arrays.free_values.begin(), arrays.free_values.end());
+        tree.free_top_slots_.assign(arrays.free_top_slots.begin(), arrays.free_top_slots.end());
+
+        auto& name_to_index = prefix::steam_game_name_to_index_map;
+        name_to_index.reserve(arrays.name_map.size);
+        for (std::uint32_t index : arrays.name_map) {
+                name_to_index.emplace(steam_game_collection.LowerName(index), index);
+        }
+        auto& app_id_to_index = prefix::steam_game_app_id_to_index_map;
+        app_id_to_index.reserve(arrays.app_id_map.size);
+        for (std::uint32_t index : arrays.app_id_map) {
+                app_id_to_index.emplace(steam_game_collection.AppId(index), index);
+        }
+
+        /* * Borrowing first and taking ownership copies the lists exactly as a borrowed index would. */
+        infix::steam_game_name_infix_index.Borrow(arrays.infix_grams, arrays.infix_offsets, arrays.infix_postings);
+        infix::steam_game_name_infix_index.TakeOwnership();
+        token::steam_game_name_token_index.Borrow(
+            arrays.token_word_offsets, arrays.token_words, arrays.token_offsets, arrays.token_postings);
+        token::steam_game_name_token_index.TakeOwnership();
+}
+
+/* * Points every index at checked index arrays without copying them; the mapping must stay open. */
+static void BorrowIndexes(const IndexArrays& arrays)
+{
+        auto& tree = prefix::steam_game_name_prefix_tree;
+        tree.nodes_.Borrow(arrays.nodes.data, arrays.nodes.size);
+        tree.value_entries_.Borrow(arrays.values.data, arrays.values.size);
+        tree.label_arena_.Borrow(arrays.labels.data(), arrays.labels.size());
+        tree.top_by_playtime_.Borrow(arrays.top_caches.data, arrays.top_caches.size);
+        tree.free_nodes_.assign(arrays.free_nodes.begin(), arrays.free_nodes.end());
+        tree.free_values_.assign(arrays.free_values.begin(), arrays.free_values.end());
+        tree.free_top_slots_.assign(arrays.free_top_slots.begin(), arrays.free_top_slots.end());
+
+        catalog::BorrowLookups(arrays.name_map, arrays.app_id_map);
+        infix::steam_game_name_infix_index.Borrow(arrays.infix_grams, arrays.infix_offsets, arrays.infix_postings);
+        token::steam_game_name_token_index.Borrow(
+            arrays.token_word_offsets, arrays.token_words, arrays.token_offsets, arrays.token_postings);
+}
+
+SnapshotImages BuildSnapshotImages()
+{
+        const data::GameColumns columns = steam_game_collection.Columns();
+        const size_t            count   = columns.count;
+
+        std::uint64_t  checksum = 0;
+        SnapshotImages images;
+        images.games = BuildImage(
+            kGamesMagic,
+            kGamesFormatVersion,
+            0,
+            { { steam_current_user_data.username.data(), steam_current_user_data.username.size() },
+              { steam_current_user_data.location.data(), steam_current_user_data.location.size() },
+              { steam_current_user_data.steam_id.data(), steam_current_user_data.steam_id.size() },
+              { columns.app_ids, count * sizeof(int) },
+              { columns.playtimes, count * sizeof(int) },
+              { columns.name_offsets, count * sizeof(std::uint32_t) },
+              { columns.name_lengths, count * sizeof(std::uint32_t) },
+              { columns.lower_name_offsets, count * sizeof(std::uint32_t) },
+              { columns.lower_name_lengths, count * sizeof(std::uint32_t) },
+              { columns.name_arena.data(), columns.name_arena.size() } },
+            &checksum);
+        images.index = BuildIndexImage(checksum);
+        return images;
+}
+
+bool WriteSnapshotImages(const SnapshotImages&        images,
+                         const std::filesystem::path& games_path,
+                         const std::filesystem::path& index_path)
+{
+        /* * Versioned files are written once and then only read, so no rename ever lands on a file a reader maps;
+         * * an index already built for these games is as good as a new one. The pointer is the one file readers
+         * * watch, so it goes last: both files it names are complete when it appears. */
+        const std::uint64_t         version    = ImageVersion(images.games);
+        const std::filesystem::path games_file = VersionedPath(games_path, version);
+        const std::filesystem::path index_file = VersionedPath(index_path, version);
+        if (!(IndexBuiltFor(index_file, version) || WriteImage(images.index, index_file))
+            || !(FileHoldsImage(games_file, images.games) || WriteImage(images.games, games_file))) {
+                return false;
+        }
+        Pointer pointer = {};
+        std::memcpy(pointer.magic, kPointerMagic, sizeof(kPointerMagic));
+        pointer.version      = version;
+        const bool published = WriteFileAtomically(games_path, [&pointer](std::FILE* file) {
+                return std::fwrite(&pointer, sizeof(Pointer), 1, file) == 1;
+        });
+        if (published) {
+                RemoveStaleVersions(games_path, index_path, version);
+        }
+        return published;
+}
+
+bool SaveGamesSnapshot(const std::filesystem::path& games_path, const std::filesystem::path& index_path)
+{
+        return WriteSnapshotImages(BuildSnapshotImages(), games_path, index_path);
+}
+
+/* * Views the columns of a checked games file; false if one is missing or a name lies outside the arena. */
+static bool ReadGameColumns(const SnapshotReader& reader, data::GameColumns& columns)
+{
+        /* * Every game takes at least 24 bytes of columns, which also keeps count * 4 from overflowing. */
+        const std::uint64_t count = reader.header().game_count;
+        if (count > reader.header().file_size) {
+                return false;
+        }
+        columns.count              = static_cast<size_t>(count);
+        columns.app_ids            = reader.Column<int>(kAppIds, columns.count);
+        columns.playtimes          = reader.Column<int>(kPlaytimes, columns.count);
+        columns.name_offsets       = reader.Column<std::uint32_t>(kNameOffsets, columns.count);
+        columns.name_lengths       = reader.Column<std::uint32_t>(kNameLengths, columns.count);
+        columns.lower_name_offsets = reader.Column<std::uint32_t>(kLowerNameOffsets, columns.count);
+        columns.lower_name_lengths = reader.Column<std::uint32_t>(kLowerNameLengths, columns.count);
+        columns.name_arena         = reader.Bytes(kNameArena);
+        if (columns.app_ids == nullptr || columns.playtimes == nullptr || columns.name_offsets == nullptr
+            || columns.name_lengths == nullptr || columns.lower_name_offsets == nullptr
+            || columns.lower_name_lengths == nullptr) {
+                return false;
+        }
+
+        /* * The checksum only proves the file is intact; a crafted one could still point outside the arena. */
+        const std::uint64_t arena_size = columns.name_arena.size();
+        for (size_t index = 0; index < columns.count; ++index) {
+                if (std::uint64_t{ columns.name_offsets[index] } + columns.name_lengths[index] > arena_size
+                    || std::uint64_t{ columns.lower_name_offsets[index] } + columns.lower_name_lengths[index]
+                           > arena_size) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+static void ReadUserData(const SnapshotReader& reader)
+{
+        steam_current_user_data.username = std::string(reader.Bytes(kUsername));
+        steam_current_user_data.location = std::string(reader.Bytes(kLocation));
+        steam_current_user_data.steam_id = std::string(reader.Bytes(kSteamId));
+}
+
+bool LoadGamesSnapshot(const std::filesystem::path& games_path,
+                       const std::filesystem::path& index_path,
+                       bool                         rewrite_stale_index)
+{
+        const SnapshotFiles files = ResolveSnapshot(games_path, index_path);
+        SnapshotReader      reader;
+        data::GameColumns   columns;
+        if (!reader.Open(files.games, kGamesMagic, kGamesFormatVersion, kGamesSectionCount)
+            || !ReadGameColumns(reader, columns)) {
+                return false;
+        }
+
+        const std::uint64_t source_hash = reader.header().checksum;
+        const bool          restored    = catalog::LoadColumns(columns, [&] {
+                SnapshotReader index_reader;
+                IndexArrays    arrays;
+                if (!OpenIndexArrays(index_reader, files.index, source_hash, columns, arrays)) {
+                        return false;
+                }
+                RestoreIndexes(arrays);
+                return true;
+        });
+        if (!restored && rewrite_stale_index) {
+                WriteImage(BuildIndexImage(source_hash), files.index);
+        }
+        ReadUserData(reader);
+        return true;
+}
+
+/* * Mappings the library borrows from since the last successful ShareGamesSnapshot. */
+static std::unique_ptr<SnapshotReader> shared_games_reader;
+static std::unique_ptr<SnapshotReader> shared_index_reader;
+/* * Checksum of the games file ShareGamesSnapshot last looked at, whether or not it could be shared. */
+static std::optional<std::uint64_t> last_shared_checksum;
+
+bool ShareGamesSnapshot(const std::filesystem::path& games_path, const std::filesystem::path& index_path)
+{
+        const SnapshotFiles files        = ResolveSnapshot(games_path, index_path);
+        auto                games_reader = std::make_unique<SnapshotReader>();
+        auto                index_reader = std::make_unique<SnapshotReader>();
+        if (!games_reader->Open(files.games, kGamesMagic, kGamesFormatVersion, kGamesSectionCount)) {
+                return false;
+        }
+        last_shared_checksum = games_reader->header().checksum;
+
+        data::GameColumns columns;
+        IndexArrays       arrays;
+        if (!ReadGameColumns(*games_reader, columns)
+            || !OpenIndexArrays(*index_reader, files.index, games_reader->header().checksum, columns, arrays)) {
+                return false;
+        }
+        catalog::BorrowColumns(columns);
+        BorrowIndexes(arrays);
+        ReadUserData(*games_reader);
+        /* * Only now is nothing left pointing into the previous mappings. */
+        shared_games_reader = std::move(games_reader);
+        shared_index_reader = std::move(index_reader);
+        return true;
+}
+
+bool SharedSnapshotChanged(const std::filesystem::path& games_path)
+{
+        if (!last_shared_checksum) {
+                return true;
+        }
+        if (const std::optional<std::uint64_t> version = ReadPointer(games_path)) {
+                return *version != *last_shared_checksum;
+        }
+        Header header = {};
+        return ReadHeader(games_path, header) && header.checksum != *last_shared_checksum;
+}
+
+size_t SharedSnapshotBytes()
+{
+        if (!shared_games_reader || !steam_game_collection.IsBorrowed()) {
+                return 0;
+        }
+        return shared_games_reader->size() + shared_index_reader->size();
+}
+
+std::string BuildProfileStoreImage()
+{
+        const auto& store = profile::steam_profile_store;
+
+        std::vector<std::uint32_t> string_offsets(1, 0);
+        std::string                strings;
+        std::vector<std::uint32_t> game_offsets(1, 0);
+        std::vector<std::uint32_t> app_indices;
+        std::vector<int>           playtimes;
+        for (const auto& [steam_id, stored] : store.profiles_) {
+                for (const std::string* text : { &steam_id, &stored.user.username, &stored.user.location }) {
+                        strings.append(*text);
+                        string_offsets.push_back(static_cast<std::uint32_t>(strings.size()));
+                }
+                app_indices.insert(app_indices.end(), stored.app_indices.begin(), stored.app_indices.end());
+                playtimes.insert(playtimes.end(), stored.playtimes.begin(), stored.playtimes.end());
+                game_offsets.push_back(static_cast<std::uint32_t>(app_indices.size()));
+        }
+
+        const auto array = [](const auto& values) {
+                return Payload{ values.data(), values.size() * sizeof(values[0]) };
+        };
+        return BuildImage(kProfileMagic,
+                          kProfileFormatVersion,
+                          0,
+                          { array(store.app_ids_),
+                            array(store.name_offsets_),
+                            array(store.name_lengths_),
+                            array(store.name_arena_),
+                            array(string_offsets),
+                            array(strings),
+                            array(game_offsets),
+                            array(app_indices),
+                            array(playtimes) });
+}
+
+bool WriteProfileStoreImage(const std::string& image, const std::filesystem::path& path)
+{
+        return WriteImage(image, path);
+}
+
+bool LoadProfileStore(const std::filesystem::path& path)
+{
+        SnapshotReader reader;
+        if (!reader.Open(path, kProfileMagic, kProfileFormatVersion, kProfileSectionCount)) {
+                return false;
+        }
+        ArrayView<int>           app_ids;
+        ArrayView<std::uint32_t> name_offsets;
+        ArrayView<std::uint32_t> name_lengths;
+        ArrayView<std::uint32_t> string_offsets;
+        ArrayView<std::uint32_t> game_offsets;
+        ArrayView<std::uint32_t> app_indices;
+        ArrayView<int>           playtimes;
+        if (!reader.Array(kDictionaryAppIds, app_ids) || !reader.Array(kDictionaryNameOffsets, name_offsets)
+            || !reader.Array(kDictionaryNameLengths, name_lengths)
+            || !reader.Array(kProfileStringOffsets, string_offsets) || !reader.Array(kProfileGameOffsets, game_offsets)
+            || !reader.Array(kProfileAppIndices, app_indices) || !reader.Array(kProfilePlaytimes, playtimes)) {
+                return false;
+        }
+        const std::string_view name_arena    = reader.Bytes(kDictionaryNameArena);
+        const std::string_view strings       = reader.Bytes(kProfileStrings);
+        const size_t           profile_count = game_offsets.size > 0 ? game_offsets.size - 1 : 0;
+        if (name_offsets.size != app_ids.size || name_lengths.size != app_ids.size || playtimes.size != app_indices.size
+            || string_offsets.size != 3 * profile_count + 1 || !AreOffsetsValid(string_offsets, strings.size())
+            || !AreOffsetsValid(game_offsets, app_indices.size) || !AllBelow(app_indices, app_ids.size)) {
+                return false;
+        }
+        for (size_t app = 0; app < app_ids.size; ++app) {
+                if (std::uint64_t{ name_offsets[app] } + name_lengths[app] > name_arena.size()) {
+                        return false;
+                }
+        }
+
+        auto& store = profile::steam_profile_store;
+        store.Clear();
+        store.app_ids_.assign(app_ids.begin(), app_ids.end());
+        store.name_offsets_.assign(name_offsets.begin(), name_offsets.end());
+        store.name_lengths_.assign(name_lengths.begin(), name_lengths.end());
+        store.name_arena_.assign(name_arena);
+        store.app_index_by_id_.reserve(app_ids.size);
+        for (size_t app = 0; app < app_ids.size; ++app) {
+                store.app_index_by_id_.emplace(app_ids[app], static_cast<std::uint32_t>(app));
+        }
+        const auto text = [&](size_t string) {
+                const size_t begin = string_offsets[string];
+                return std::string(strings.substr(begin, string_offsets[string + 1] - begin));
+        };
+        for (size_t index = 0; index < profile_count; ++index) {
+                profile::Profile stored;
+                stored.user.steam_id = text(3 * index);
+                stored.user.username = text(3 * index + 1);
+                stored.user.location = text(3 * index + 2);
+                const size_t first = game_offsets[index];
+                const size_t last  = game_offsets[index + 1];
+                stored.app_indices.assign(app_indices.begin() + first, app_indices.begin() + last);
+                stored.playtimes.assign(playtimes.begin() + first, playtimes.begin() + last);
+                store.profiles_.emplace(stored.user.steam_id, std::move(stored));
+        }
+        return true;
+}
+} // namespace snapshot
+STEAM_END_NAMESPACE
@@ -2,13 +2,31 @@
 
 STEAM_BEGIN_NAMESPACE
 bool                        steam_has_fetched_data = false;
+bool                        steam_read_only        = false;
 std::string                 steam_api_key;
-std::vector<data::GameData> steam_game_collection;
+data::GameCollection        steam_game_collection;
 data::UserData              steam_current_user_data;
 std::deque<std::string>     steam_command_history;
 
+namespace loader {
+JsonStyle steam_games_json_style = JsonStyle::PRETTY;
+} // namespace loader
+
+namespace profile {
+profile::ProfileStore steam_profile_store;
+} // namespace profile
+
 namespace prefix {
-prefix::PrefixTree                      steam_game_name_prefix_tree;
-std::unordered_map<std::string, size_t> steam_game_name_to_index_map;
+prefix::PrefixTree                                                        steam_game_name_prefix_tree;
+std::unordered_map<std::string, size_t, IgnoreCaseHash, IgnoreCaseEqual> steam_game_name_to_index_map;
+std::unordered_map<int, size_t>                                           steam_game_app_id_to_index_map;
 } // namespace prefix
+
+namespace infix {
+infix::InfixIndex steam_game_name_infix_index;
+} // namespace infix
+
+namespace token {
+token::TokenIndex steam_game_name_token_index;
+} // namespace token
 STEAM_END_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "steam/token.hpp"
+
+#include <algorithm> // For std::sort, std::lower_bound
+#include "steam/utility.hpp" // For ToLower, IsWordCharacter
+
+STEAM_BEGIN_NAMESPACE
+namespace token {
+
+/* * First position at or after low whose value is >= target: doubles the step, then binary searches the last gap. */
+static size_t Gallop(ArrayView<std::uint32_t> list, size_t low, std::uint32_t target)
+{
+        size_t high = low;
+        size_t step = 1;
+        while (high < list.size && list[high] < target) {
+                low = high + 1;
+                high += step;
+                step <<= 1;
+        }
+        const auto end = list.begin() + std::min(high, list.size);
+        return static_cast<size_t>(std::lower_bound(list.begin() + low, end, target) - list.begin());
+}
+
+std::vector<std::string_view> SplitWords(std::string_view lower_text)
+{
+        std::vector<std::string_view> words;
+        size_t                        start = 0;
+        while (start < lower_text.size()) {
+                while (start < lower_text.size() && !IsWordCharacter(lower_text[start])) {
+                        ++start;
+                }
+                size_t end = start;
+                while (end < lower_text.size() && IsWordCharacter(lower_text[end])) {
+                        ++end;
+                }
+                if (end > start) {
+                        words.push_back(lower_text.substr(start, end - start));
+                }
+                start = end;
+        }
+        return words;
+}
+
+void TokenIndex::Borrow(ArrayView<std::uint32_t> word_offsets,
+                        std::string_view         words,
+                        ArrayView<std::uint32_t> offsets,
+                        ArrayView<std::uint32_t> postings)
+{
+        Clear();
+        borrowed_word_offsets_ = word_offsets;
+        borrowed_words_        = words;
+        borrowed_offsets_      = offsets;
+        borrowed_postings_     = postings;
+}
+
+void TokenIndex::TakeOwnership()
+{
+        if (!IsBorrowed()) {
+                return;
+        }
+        /* * Borrowed words ascend, so each one goes in at the end in constant time. */
+        for (size_t i = 0; i + 1 < borrowed_offsets_.size; ++i) {
+                postings_.emplace_hint(postings_.end(),
+                                       BorrowedWord(i),
+                                       std::vector<std::uint32_t>(borrowed_postings_.data + borrowed_offsets_[i],
+                                                                  borrowed_postings_.data + borrowed_offsets_[i + 1]));
+        }
+        borrowed_word_offsets_ = {};
+        borrowed_words_        = {};
+        borrowed_offsets_      = {};
+        borrowed_postings_     = {};
+}
+
+size_t TokenIndex::Insert(std::string_view lower_name, size_t game_index)
+{
+        TakeOwnership();
+        const auto index = static_cast<std::uint32_t>(game_index);
+        size_t     added = 0;
+        for (std::string_view word : SplitWords(lower_name)) {
+                auto posting_it = postings_.find(word);
+                if (posting_it == postings_.end()) {
+                        posting_it = postings_.emplace(std::string(word), std::vector<std::uint32_t>()).first;
+                }
+                auto& posting = posting_it->second;
+                if (posting.empty() || posting.back() < index) {
+                        posting.push_back(index);
+                        ++added;
+                } else {
+                        auto position = std::lower_bound(posting.begin(), posting.end(), index);
+                        if (*position != index) {
+                                posting.insert(position, index);
+                                ++added;
+                        }
+                }
+        }
+        return added;
+}
+
+size_t TokenIndex::Erase(std::string_view lower_name, size_t game_index)
+{
+        TakeOwnership();
+        const auto index   = static_cast<std::uint32_t>(game_index);
+        size_t     removed = 0;
+        for (std::string_view word : SplitWords(lower_name)) {
+                auto posting_it = postings_.find(word);
+                if (posting_it == postings_.end()) {
+                        continue; /* * Repeated word, already erased. */
+                }
+                auto& posting  = posting_it->second;
+                auto  position = std::lower_bound(posting.begin(), posting.end(), index);
+                if (position != posting.end() && *position == index) {
+                        posting.erase(position);
+                        ++removed;
+                }
+                if (posting.empty()) {
+                        postings_.erase(posting_it);
+                }
+        }
+        return removed;
+}
+
+ArrayView<std::uint32_t> TokenIndex::MatchingGames(std::string_view            query_word,
+                                                   std::vector<std::uint32_t>& scratch) const
+{
+        std::vector<ArrayView<std::uint32_t>> lists;
+        if (IsBorrowed()) {
+                size_t low  = 0;
+                size_t high = borrowed_offsets_.size - 1;
+                while (low < high) {
+                        const size_t middle = low + (high - low) / 2;
+                        if (BorrowedWord(middle) < query_word) {
+                                low = middle + 1;
+                        } else {
+                                high = middle;
+                        }
+                }
+                for (size_t i = low; i + 1 < borrowed_offsets_.size
+                                     && BorrowedWord(i).compare(0, query_word.size(), query_word) == 0;
+                     ++i) {
+                        const size_t first = borrowed_offsets_[i];
+                        lists.push_back({ borrowed_postings_.data + first, borrowed_offsets_[i + 1] - first });
+                }
+        } else {
+                for (auto it = postings_.lower_bound(query_word);
+                     it != postings_.end() && it->first.compare(0, query_word.size(), query_word) == 0;
+                     ++it) {
+                        lists.push_back({ it->second.data(), it->second.size() });
+                }
+        }
+        if (lists.size() <= 1) {
+                return lists.empty() ? ArrayView<std::uint32_t>() : lists.front();
+        }
+        scratch.clear();
+        for (const auto& list : lists) {
+                scratch.insert(scratch.end(), list.begin(), list.end());
+        }
+        std::sort(scratch.begin(), scratch.end());
+        scratch.erase(std::unique(scratch.begin(), scratch.end()), scratch.end());
+        return { scratch.data(), scratch.size() };
+}
+
+std::vector<size_t> TokenIndex::SearchAllWords(const std::string& text) const
+{
+        const std::string   lower_text  = ToLower(text);
+        const auto          query_words = SplitWords(lower_text);
+        std::vector<size_t> indices;
+        if (query_words.empty()) {
+                return indices;
+        }
+
+        std::vector<std::vector<std::uint32_t>> merged(query_words.size());
+        std::vector<ArrayView<std::uint32_t>>   lists;
+        for (size_t i = 0; i < query_words.size(); ++i) {
+                const ArrayView<std::uint32_t> list = MatchingGames(query_words[i], merged[i]);
+                if (list.size == 0) {
+                        return indices;
+                }
+                lists.push_back(list);
+        }
+        std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) {
+                return a.size < b.size;
+        });
+
+        std::vector<std::uint32_t> candidates(lists.front().begin(), lists.front().end());
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+                const auto& list     = lists[i];
+                size_t      position = 0;
+                size_t      kept     = 0;
+                for (std::uint32_t candidate : candidates) {
+                        position = Gallop(list, position, candidate);
+                        if (position == list.size) {
+                                break;
+                        }
+                        if (list[position] == candidate) {
+                                candidates[kept++] = candidate;
+                        }
+                }
+                candidates.resize(kept);
+        }
+
+        struct RankedGame
+        {
+                size_t index;
+                size_t whole_word_hits; /* * Query words equal to a name word rather than a prefix of one */
+                bool   in_order;        /* * Query words first appear in the name in the order they were typed */
+                size_t name_words;      /* * Fewer extra words means a closer match */
+        };
+        std::vector<RankedGame> ranked;
+        ranked.reserve(candidates.size());
+        for (std::uint32_t index : candidates) {
+                if (index >= steam_game_collection.size()) {
+                        continue;
+                }
+                const auto name_words    = SplitWords(steam_game_collection.LowerName(index));
+                RankedGame game          = { index, 0, true, name_words.size() };
+                size_t     last_position = 0;
+                for (std::string_view query_word : query_words) {
+                        size_t position = name_words.size();
+                        for (size_t w = 0; w < name_words.size(); ++w) {
+                                if (name_words[w] == query_word) {
+                                        ++game.whole_word_hits;
+                                        position = std::min(position, w);
+                                        break;
+                                }
+                                if (position == name_words.size()
+                                    && name_words[w].compare(0, query_word.size(), query_word) == 0) {
+                                        position = w;
+                                }
+                        }
+                        game.in_order = game.in_order && position >= last_position;
+                        last_position = position;
+                }
+                ranked.push_back(game);
+        }
+        std::sort(ranked.begin(), ranked.end(), [](const RankedGame& a, const RankedGame& b) {
+                if (a.whole_word_hits != b.whole_word_hits) {
+                        return a.whole_word_hits > b.whole_word_hits;
+                }
+                if (a.in_order != b.in_order) {
+                        return a.in_order;
+                }
+                if (a.name_words != b.name_words) {
+                        return a.name_words < b.name_words;
+                }
+                const auto name_a = steam_game_collection.LowerName(a.index);
+                const auto name_b = steam_game_collection.LowerName(b.index);
+                return name_a != name_b ? name_a < name_b : a.index < b.index;
+        });
+
+        indices.reserve(ranked.size());
+        for (const auto& game : ranked) {
+                indices.push_back(game.index);
+        }
+        return indices;
+}
+
+size_t TokenIndex::MemoryUsage() const
+{
+        /* * Red-black tree node: three pointers and a color word besides the stored pair. */
+        size_t bytes = 0;
+        for (const auto& [word, posting] : postings_) {
+                bytes += 4 * sizeof(void*) + sizeof(word) + word.capacity() + sizeof(posting)
+                         + posting.capacity() * sizeof(std::uint32_t);
+        }
+        return bytes;
+}
+} // namespace token
+STEAM_END_NAMESPACE
@@ -2,7 +2,7 @@
 #include "steam/undo.hpp"
 
 #include "steam/data.hpp"  // For fmt
-#include "steam/graph.hpp" // For graph::RemoveRelation and graph::SaveRelations
+#include "steam/graph.hpp" // For graph::EditRelation
 
 #include <vector> // For managing stack size if kMaxUndoHistory is enforced strictly
 
@@ -48,8 +48,7 @@ bool PopAndExecuteUndo()
 
         switch (last_action.type) {
         case ActionType::ADD_RELATION:
-                graph::RemoveRelation(last_action.param1, last_action.param2);
-                graph::SaveRelations(); // Save changes after undo
+                graph::EditRelation(graph::RelationEdit::REMOVE, last_action.param1, last_action.param2);
                 fmt::print(
                     fmt::fg(fmt::color::light_green),
                     "Successfully undone the relation between AppID {} and AppID {}.\n",
@@ -2,19 +2,320 @@
 
 #include "steam/utility.hpp" // Includes filesystem
 
-#include <algorithm> // For std::transform
-#include <cctype>    // For std::tolower
+#include <atomic> // For the temp file counter in WriteFileAtomically
+#include <cstdint>
 #include <string>
 
+#ifdef _WIN32
+#include <io.h>      // For _commit, _fileno
+#include <process.h> // For _getpid
+#else
+#include <fcntl.h>  // For open
+#include <unistd.h> // For fsync, close, getpid
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define STEAM_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
 STEAM_BEGIN_NAMESPACE
 
-std::string ToLower(const std::string& input_string)
+/* * Lowers 'A'-'Z' from input into output and reports whether any byte was non-ASCII. */
+using AsciiToLowerFunction = bool (*)(const char* input, char* output, size_t length);
+
+static bool AsciiToLowerScalar(const char* input, char* output, size_t length)
+{
+        unsigned char seen = 0;
+        for (size_t i = 0; i < length; ++i) {
+                const auto byte = static_cast<unsigned char>(input[i]);
+                seen |= byte;
+                output[i] = static_cast<char>(static_cast<unsigned>(byte - 'A') < 26u ? byte + 0x20 : byte);
+        }
+        return (seen & 0x80) != 0;
+}
+
+#ifdef STEAM_X86_SIMD
+/* * Shifting 'A' to -128 turns "is upper case" into one signed compare against -128 + 26. */
+static bool AsciiToLowerSse2(const char* input, char* output, size_t length)
+{
+        const __m128i shift     = _mm_set1_epi8(static_cast<char>(0x80 - 'A'));
+        const __m128i threshold = _mm_set1_epi8(static_cast<char>(-128 + 26));
+        const __m128i case_bit  = _mm_set1_epi8(0x20);
+        __m128i       seen      = _mm_setzero_si128();
+        size_t        i         = 0;
+        for (; i + 16 <= length; i += 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+                const __m128i upper = _mm_cmplt_epi8(_mm_add_epi8(bytes, shift), threshold);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+                                 _mm_add_epi8(bytes, _mm_and_si128(upper, case_bit)));
+                seen = _mm_or_si128(seen, bytes);
+        }
+        const bool tail_non_ascii = AsciiToLowerScalar(input + i, output + i, length - i);
+        return _mm_movemask_epi8(seen) != 0 || tail_non_ascii;
+}
+
+__attribute__((target("avx2"))) static bool AsciiToLowerAvx2(const char* input, char* output, size_t length)
+{
+        const __m256i shift     = _mm256_set1_epi8(static_cast<char>(0x80 - 'A'));
+        const __m256i threshold = _mm256_set1_epi8(static_cast<char>(-128 + 26));
+        const __m256i case_bit  = _mm256_set1_epi8(0x20);
+        __m256i       seen      = _mm256_setzero_si256();
+        size_t        i         = 0;
+        for (; i + 32 <= length; i += 32) {
+                const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+                const __m256i upper = _mm256_cmpgt_epi8(threshold, _mm256_add_epi8(bytes, shift));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i),
+                                    _mm256_add_epi8(bytes, _mm256_and_si256(upper, case_bit)));
+                seen = _mm256_or_si256(seen, bytes);
+        }
+        const bool tail_non_ascii = AsciiToLowerSse2(input + i, output + i, length - i);
+        return _mm256_movemask_epi8(seen) != 0 || tail_non_ascii;
+}
+#endif
+
+/* * Picks the widest ASCII lowering routine the running CPU supports. */
+static AsciiToLowerFunction SelectAsciiToLower()
+{
+#ifdef STEAM_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+                return AsciiToLowerAvx2;
+        }
+        return AsciiToLowerSse2;
+#else
+        return AsciiToLowerScalar;
+#endif
+}
+
+/* * Code points past U+10FFFF stand for bytes that are not valid UTF-8, so they compare and hash as themselves. */
+static constexpr char32_t kMalformedByteBase = 0x110000;
+
+/**
+ * @brief Decodes the UTF-8 sequence starting at text[position] and advances position past it.
+ * * A byte that does not start a well-formed sequence decodes to kMalformedByteBase + byte.
+ */
+static char32_t DecodeUtf8(std::string_view text, size_t& position)
+{
+        const auto lead = static_cast<unsigned char>(text[position]);
+        size_t     length;
+        char32_t   code_point;
+        if (lead < 0x80) {
+                ++position;
+                return lead;
+        } else if (lead >= 0xC2 && lead <= 0xDF) {
+                length     = 2;
+                code_point = lead & 0x1F;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+                length     = 3;
+                code_point = lead & 0x0F;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+                length     = 4;
+                code_point = lead & 0x07;
+        } else {
+                ++position;
+                return kMalformedByteBase + lead;
+        }
+        if (position + length > text.size()) {
+                ++position;
+                return kMalformedByteBase + lead;
+        }
+        for (size_t i = 1; i < length; ++i) {
+                const auto continuation = static_cast<unsigned char>(text[position + i]);
+                if ((continuation & 0xC0) != 0x80) {
+                        ++position;
+                        return kMalformedByteBase + lead;
+                }
+                code_point = (code_point << 6) | (continuation & 0x3F);
+        }
+        /* * Reject overlong forms, surrogates and values past U+10FFFF. */
+        if ((length == 3 && (code_point < 0x800 || (code_point >= 0xD800 && code_point <= 0xDFFF)))
+            || (length == 4 && (code_point < 0x10000 || code_point > 0x10FFFF))) {
+                ++position;
+                return kMalformedByteBase + lead;
+        }
+        position += length;
+        return code_point;
+}
+
+static void AppendUtf8(std::string& output, char32_t code_point)
+{
+        if (code_point >= kMalformedByteBase) {
+                output.push_back(static_cast<char>(code_point - kMalformedByteBase));
+        } else if (code_point < 0x80) {
+                output.push_back(static_cast<char>(code_point));
+        } else if (code_point < 0x800) {
+                output.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+                output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        } else if (code_point < 0x10000) {
+                output.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+                output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        } else {
+                output.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+                output.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+        }
+}
+
+/**
+ * @brief Simple (one-to-one) Unicode case folding for the scripts game titles use.
+ * * Covers Latin-1, Latin Extended-A, Latin Extended Additional, Greek, Cyrillic and fullwidth Latin.
+ * * Multi-character folds such as U+00DF -> "ss" are left alone so folding never changes the letter count.
+ */
+static char32_t FoldCodePoint(char32_t code_point)
+{
+        if (code_point < 0x80) {
+                return code_point - 'A' < 26u ? code_point + 0x20 : code_point;
+        }
+        if (code_point < 0x100) {
+                if (code_point >= 0xC0 && code_point <= 0xDE && code_point != 0xD7) {
+                        return code_point + 0x20;
+                }
+                return code_point == 0xB5 ? 0x3BC : code_point; /* * Micro sign folds to Greek mu. */
+        }
+        if (code_point <= 0x17F) { /* * Latin Extended-A: mostly upper/lower pairs on even/odd code points. */
+                switch (code_point) {
+                case 0x130:
+                        return 'i';
+                case 0x131:
+                case 0x138:
+                case 0x149:
+                        return code_point;
+                case 0x178:
+                        return 0xFF;
+                case 0x17F:
+                        return 's';
+                }
+                if ((code_point >= 0x139 && code_point <= 0x148) || (code_point >= 0x179 && code_point <= 0x17E)) {
+                        return (code_point & 1) ? code_point + 1 : code_point;
+                }
+                return (code_point & 1) ? code_point : code_point + 1;
+        }
+        if (code_point >= 0x370 && code_point <= 0x3FF) { /* * Greek */
+                if (code_point >= 0x391 && code_point <= 0x3AB && code_point != 0x3A2) {
+                        return code_point + 0x20;
+                }
+                switch (code_point) {
+                case 0x386:
+                        return 0x3AC;
+                case 0x388:
+                case 0x389:
+                case 0x38A:
+                        return code_point + 0x25;
+                case 0x38C:
+                        return 0x3CC;
+                case 0x38E:
+                case 0x38F:
+                        return code_point + 0x3F;
+                case 0x3C2:
+                        return 0x3C3; /* * Final sigma folds to sigma. */
+                }
+                return code_point;
+        }
+        if (code_point >= 0x400 && code_point <= 0x52F) { /* * Cyrillic */
+                if (code_point <= 0x40F) {
+                        return code_point + 0x50;
+                }
+                if (code_point <= 0x42F) {
+                        return code_point + 0x20;
+                }
+                if (code_point == 0x4C0) {
+                        return 0x4CF;
+                }
+                if ((code_point >= 0x460 && code_point <= 0x481) || (code_point >= 0x48A && code_point <= 0x4BF)
+                    || code_point >= 0x4D0) {
+                        return (code_point & 1) ? code_point : code_point + 1;
+                }
+                if (code_point >= 0x4C1 && code_point <= 0x4CE) {
+                        return (code_point & 1) ? code_point + 1 : code_point;
+                }
+                return code_point;
+        }
+        if (code_point >= 0x1E00 && code_point <= 0x1EFF) { /* * Latin Extended Additional (Vietnamese, Welsh) */
+                if (code_point == 0x1E9E) {
+                        return 0xDF;
+                }
+                if (code_point >= 0x1E96 && code_point <= 0x1E9F) {
+                        return code_point;
+                }
+                return (code_point & 1) ? code_point : code_point + 1;
+        }
+        if (code_point >= 0xFF21 && code_point <= 0xFF3A) { /* * Fullwidth Latin capitals */
+                return code_point + 0x20;
+        }
+        return code_point;
+}
+
+std::string ToLower(std::string_view input_string)
+{
+        static const AsciiToLowerFunction ascii_to_lower = SelectAsciiToLower();
+
+        std::string result(input_string.size(), '\0');
+        if (!ascii_to_lower(input_string.data(), result.data(), input_string.size())) {
+                return result;
+        }
+
+        /* * Slow path: ASCII bytes are already lowered, fold the multi-byte sequences. */
+        std::string folded;
+        folded.reserve(result.size());
+        for (size_t position = 0; position < result.size();) {
+                if (static_cast<unsigned char>(result[position]) < 0x80) {
+                        folded.push_back(result[position++]);
+                } else {
+                        AppendUtf8(folded, FoldCodePoint(DecodeUtf8(result, position)));
+                }
+        }
+        return folded;
+}
+
+int CompareIgnoreCase(std::string_view a, std::string_view b)
 {
-        std::string result = input_string;
-        std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {
-                return static_cast<char>(std::tolower(c));
-        });
-        return result;
+        size_t position_a = 0;
+        size_t position_b = 0;
+        while (position_a < a.size() && position_b < b.size()) {
+                const auto byte_a = static_cast<unsigned char>(a[position_a]);
+                const auto byte_b = static_cast<unsigned char>(b[position_b]);
+                char32_t   folded_a;
+                char32_t   folded_b;
+                if ((byte_a | byte_b) < 0x80) {
+                        folded_a = FoldCodePoint(byte_a);
+                        folded_b = FoldCodePoint(byte_b);
+                        ++position_a;
+                        ++position_b;
+                } else {
+                        folded_a = FoldCodePoint(DecodeUtf8(a, position_a));
+                        folded_b = FoldCodePoint(DecodeUtf8(b, position_b));
+                }
+                if (folded_a != folded_b) {
+                        return folded_a < folded_b ? -1 : 1;
+                }
+        }
+        if (position_a < a.size()) {
+                return 1;
+        }
+        return position_b < b.size() ? -1 : 0;
+}
+
+size_t HashIgnoreCase(std::string_view input_string)
+{
+        /* * 64-bit FNV-1a over the folded code points: one byte each below U+0080, three bytes otherwise. */
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t position = 0; position < input_string.size();) {
+                char32_t folded;
+                if (static_cast<unsigned char>(input_string[position]) < 0x80) {
+                        folded = FoldCodePoint(static_cast<unsigned char>(input_string[position++]));
+                } else {
+                        folded = FoldCodePoint(DecodeUtf8(input_string, position));
+                }
+                hash = (hash ^ (folded & 0xFF)) * 0x100000001b3ull;
+                if (folded >= 0x80) {
+                        hash = (hash ^ ((folded >> 8) & 0xFF)) * 0x100000001b3ull;
+                        hash = (hash ^ (folded >> 16)) * 0x100000001b3ull;
+                }
+        }
+        return static_cast<size_t>(hash);
 }
 
 std::filesystem::path GetGamesDataPath()
@@ -25,4 +326,109 @@ std::filesystem::path GetGamesDataPath()
         }
         return data_dir_path / kGamesDataJsonFile;
 }
-STEAM_END_NAMESPACE
\ No newline at end of file
+
+std::filesystem::path GetGamesSnapshotPath()
+{
+        return GetGamesDataPath().parent_path() / kGamesSnapshotFile;
+}
+
+std::filesystem::path GetIndexSnapshotPath()
+{
+        return GetGamesDataPath().parent_path() / kIndexSnapshotFile;
+}
+
+std::filesystem::path GetProfileStorePath()
+{
+        return GetGamesDataPath().parent_path() / kProfileStoreFile;
+}
+
+std::filesystem::path GetPlaytimeHistoryPath()
+{
+        return GetGamesDataPath().parent_path() / kPlaytimeHistoryFile;
+}
+
+std::filesystem::path GetApiKeyCachePath()
+{
+        return GetGamesDataPath().parent_path() / kApiKeyCacheFile;
+}
+
+std::FILE* OpenFile(const std::filesystem::path& path, const char* mode)
+{
+#ifdef _WIN32
+        const std::wstring wide_mode(mode, mode + std::char_traits<char>::length(mode));
+        return _wfopen(path.c_str(), wide_mode.c_str());
+#else
+        return std::fopen(path.c_str(), mode);
+#endif
+}
+
+bool FlushFileToDisk(std::FILE* file)
+{
+        if (std::fflush(file) != 0) {
+                return false;
+        }
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return ::fsync(fileno(file)) == 0;
+#endif
+}
+
+bool WriteFileAtomically(const std::filesystem::path& path, const std::function<bool(std::FILE*)>& write)
+{
+        /* * Unique per process and call, so two writers of the same file never share a temp file. */
+        static std::atomic<std::uint64_t> temp_counter{ 0 };
+#ifdef _WIN32
+        const auto process_id = _getpid();
+#else
+        const auto process_id = ::getpid();
+#endif
+        std::filesystem::path temp_path = path;
+        temp_path += "." + std::to_string(process_id) + "." + std::to_string(temp_counter++) + ".tmp";
+        std::FILE* file = OpenFile(temp_path, "wb");
+        if (file == nullptr) {
+                return false;
+        }
+        const bool written = write(file) && FlushFileToDisk(file);
+        if (std::fclose(file) != 0 || !written) {
+                std::error_code ignored;
+                std::filesystem::remove(temp_path, ignored);
+                return false;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temp_path, path, error);
+        if (error) {
+                std::filesystem::remove(temp_path, error);
+                return false;
+        }
+#ifndef _WIN32
+        /* * The rename itself is only durable once the directory entry is flushed too. */
+        const int directory = ::open(path.parent_path().empty() ? "." : path.parent_path().c_str(), O_RDONLY);
+        if (directory >= 0) {
+                ::fsync(directory);
+                ::close(directory);
+        }
+#endif
+        return true;
+}
+
+std::string EncodeUrlComponent(std::string_view text)
+{
+        static constexpr char kHexDigits[] = "0123456789ABCDEF";
+        std::string           encoded;
+        encoded.reserve(text.size());
+        for (const char ch : text) {
+                const auto byte = static_cast<unsigned char>(ch);
+                if ((byte >= '0' && byte <= '9') || ((byte | 0x20) >= 'a' && (byte | 0x20) <= 'z') || byte == '-'
+                    || byte == '.' || byte == '_' || byte == '~') {
+                        encoded += ch;
+                } else {
+                        encoded += '%';
+                        encoded += kHexDigits[byte >> 4];
+                        encoded += kHexDigits[byte & 0x0F];
+                }
+        }
+        return encoded;
+}
+STEAM_END_NAMESPACE